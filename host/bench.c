@@ -0,0 +1,158 @@
+// Frame cost of the face on the host, per scenario: cycles, allocations,
+// fills and pixels written per frame, and how much of the screen they cover.
+#include <pebble.h>
+#include "host.h"
+#include "fctx-layer.h"
+#ifndef PBL_PLATFORM_APLITE
+#include "ffont-cache.h"
+#include "glyph-atlas.h"
+#endif
+
+typedef void (*BenchStep)(void);
+
+static void prv_report(const char *name) {
+    HostFrameStats stats = host_frame_stats();
+    HostHeapStats heap = host_heap_stats();
+    uint32_t frames = stats.frames ? stats.frames : 1;
+    printf("%-10s %6lu %10llu %10llu %8.1f %8.1f %8lu  %3d,%3d %3dx%3d %8zu\n", name,
+           (unsigned long) stats.frames,
+           (unsigned long long) (stats.cycles / frames / 1000), (unsigned long long) (stats.max_cycles / 1000),
+           (double) stats.allocs / frames, (double) stats.fills / frames, (unsigned long) (stats.pixels / frames),
+           stats.touched.origin.x, stats.touched.origin.y, stats.touched.size.w, stats.touched.size.h, heap.peak);
+}
+
+#ifdef PROFILE
+// The profile clock counts thousands of host cycles, so the columns are in kcyc
+static uint32_t prv_profile_clock(void) {
+    return host_cycles() / 1000;
+}
+
+static void prv_profile_row(const FctxLayerProfile *profile, void *context) {
+    printf("  %-14s %6u draws %6u fills %10lu kcyc %8u kcyc max\n", profile->name ? profile->name : "unnamed",
+           profile->draws, profile->fills, (unsigned long) profile->total_ms, profile->max_ms);
+}
+#endif
+
+static void prv_run(const char *name, BenchStep step) {
+    host_frame_stats_reset();
+    host_heap_reset_peak();
+    step();
+    prv_report(name);
+    fctx_layer_profile_collect(prv_profile_row, NULL);
+    const char *dir = getenv("BENCH_DUMP");
+    if (dir) {
+        char path[256];
+        snprintf(path, sizeof(path), "%s/%s.ppm", dir, name);
+        host_dump_frame(path);
+    }
+}
+
+static void prv_warm_up(void) {
+    host_advance(1000);
+    host_send_app_ready(NULL);
+    host_advance(5000);
+}
+
+static void prv_minutes(void) {
+    for (int i = 0; i < 10; i++) host_advance_to(MINUTE_UNIT);
+}
+
+static void prv_weather(void) {
+    GenericWeatherInfo info = host_sample_weather(host_now_ms() / 1000);
+    host_send_weather(&info);
+}
+
+static void prv_settings(void) {
+    host_settings_set("COLOR_TEXT", "FFAA00");
+    host_settings_set("EXTRA_WIDGETS_ENABLED", "true");
+    host_settings_set("EXTRA_WIDGET_NW", "5");
+    host_settings_set("EXTRA_WIDGET_NE", "6");
+    host_settings_set("EXTRA_WIDGET_SW", "7");
+    host_settings_set("EXTRA_WIDGET_SE", "12");
+    host_settings_apply();
+    host_render();
+}
+
+static void prv_tap(void) {
+    host_fire_tap();
+#ifdef PBL_PLATFORM_DIORITE
+    // diorite scrolls on a double tap
+    host_fire_tap();
+#endif
+    host_advance(3000);
+}
+
+#ifndef PBL_PLATFORM_APLITE
+#define BENCH_TEXT_DRAWS 100
+
+// The time as the face draws it, rasterized by fctx and blitted from a glyph atlas
+static void prv_text(void) {
+    FFont *font = ffont_cache_acquire(RESOURCE_ID_TEXT_FFONT);
+    GlyphAtlas *atlas = glyph_atlas_create("0123456789:");
+    if (!font || !atlas) return;
+    glyph_atlas_set_background_color(atlas, GColorBlack);
+    FContext fctx;
+    fctx_init_context(&fctx, host_graphics_context());
+    const char *times[] = { "12:59", "8:07", "23:45", "10:10" };
+    GPoint origin = GPoint(PBL_DISPLAY_WIDTH / 2, 0);
+
+    uint64_t start = host_cycles();
+    bool built = glyph_atlas_draw(atlas, &fctx, font, 56, GColorWhite, times[0], origin, GTextAlignmentCenter, FTextAnchorTop);
+    uint64_t build = host_cycles() - start;
+    if (!built) {
+        printf("text 56px  atlas could not be built\n");
+        fctx_deinit_context(&fctx);
+        glyph_atlas_destroy(atlas);
+        ffont_cache_release(RESOURCE_ID_TEXT_FFONT);
+        return;
+    }
+
+    start = host_cycles();
+    for (int i = 0; i < BENCH_TEXT_DRAWS; i++) {
+        glyph_atlas_draw(atlas, &fctx, font, 56, GColorWhite, times[i % ARRAY_LENGTH(times)], origin, GTextAlignmentCenter, FTextAnchorTop);
+    }
+    uint64_t blit = host_cycles() - start;
+
+    start = host_cycles();
+    for (int i = 0; i < BENCH_TEXT_DRAWS; i++) {
+        fctx_set_offset(&fctx, g2fpoint(origin));
+        fctx_set_text_em_height(&fctx, font, 56);
+        fctx_set_fill_color(&fctx, GColorWhite);
+        fctx_begin_fill(&fctx);
+        fctx_draw_string(&fctx, times[i % ARRAY_LENGTH(times)], font, GTextAlignmentCenter, FTextAnchorTop);
+        fctx_end_fill(&fctx);
+    }
+    uint64_t fill = host_cycles() - start;
+
+    fctx_deinit_context(&fctx);
+    glyph_atlas_destroy(atlas);
+    ffont_cache_release(RESOURCE_ID_TEXT_FFONT);
+    printf("text 56px  kcyc/draw: fctx %llu, atlas %llu, atlas build %llu\n",
+           (unsigned long long) (fill / BENCH_TEXT_DRAWS / 1000), (unsigned long long) (blit / BENCH_TEXT_DRAWS / 1000),
+           (unsigned long long) (build / 1000));
+}
+#endif
+
+static void prv_scenario(void) {
+    printf("%-10s %6s %10s %10s %8s %8s %8s  %-15s %8s\n", "scenario", "frames", "kcyc/frm", "kcyc max",
+           "alloc/f", "fills/f", "px/frm", "touched", "heap pk");
+    // init and the first frame, then the services the face starts after it
+    prv_report("first");
+    fctx_layer_profile_collect(prv_profile_row, NULL);
+    printf("startup    kcyc to the first frame: %llu\n", (unsigned long long) (host_startup_cycles() / 1000));
+#ifndef PBL_PLATFORM_APLITE
+    // before the scenarios, which leave too little heap for a second atlas
+    prv_text();
+#endif
+    prv_run("warm-up", prv_warm_up);
+    prv_run("weather", prv_weather);
+    prv_run("minute", prv_minutes);
+    prv_run("settings", prv_settings);
+    prv_run("tap", prv_tap);
+}
+
+int main(void) {
+    host_log_set_level(APP_LOG_LEVEL_WARNING);
+    fctx_layer_profile_set_clock(prv_profile_clock);
+    return host_run(prv_scenario) ? 0 : 1;
+}
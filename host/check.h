@@ -0,0 +1,19 @@
+#pragma once
+// Assertions for the host tests, which keep going after a failure and report at the end
+#include <stdio.h>
+
+static int s_check_failures;
+
+#define check(cond, ...) do { \
+    if (!(cond)) { \
+        s_check_failures++; \
+        printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+        printf(__VA_ARGS__); \
+        printf("\n"); \
+    } \
+} while (0)
+
+static inline int check_report(const char *name) {
+    printf("%s: %s\n", name, s_check_failures ? "FAILED" : "ok");
+    return s_check_failures ? 1 : 0;
+}
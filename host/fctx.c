@@ -0,0 +1,410 @@
+// Stand-in for pebble-fctx, used when node_modules/pebble-fctx is not there to
+// build against. Same file formats and transform, and close enough in cost: the
+// outlines are flattened into edges and filled a scanline at a time with four
+// samples per row, nonzero winding and horizontal coverage.
+#include <pebble.h>
+#include <pebble-fctx/fctx.h>
+#include <pebble-fctx/ffont.h>
+#include <pebble-fctx/fpath.h>
+#include "host.h"
+
+#define HOST_FCTX_MAX_EDGES 4096
+#define HOST_FCTX_MAX_WIDTH 256
+#define HOST_FCTX_SUBSAMPLES 4
+#define HOST_FCTX_CURVE_STEPS 8
+
+// Fonts and paths
+
+typedef struct __attribute__((__packed__)) {
+    fixed16_t units_per_em;
+    fixed16_t ascent;
+    fixed16_t descent;
+    fixed16_t cap_height;
+    uint16_t glyph_index_length;
+    uint16_t glyph_table_length;
+} FFontHeader;
+
+FFont *ffont_create_from_resource(uint32_t resource_id) {
+    ResHandle handle = resource_get_handle(resource_id);
+    size_t size = resource_size(handle);
+    if (size < sizeof(FFontHeader)) return NULL;
+    FFont *font = malloc(sizeof(FFont));
+    if (!font) return NULL;
+    uint8_t *data = malloc(size);
+    if (!data) {
+        free(font);
+        return NULL;
+    }
+    resource_load(handle, data, size);
+
+    FFontHeader *header = (FFontHeader *) data;
+    font->units_per_em = header->units_per_em;
+    font->ascent = header->ascent;
+    font->descent = header->descent;
+    font->cap_height = header->cap_height;
+    font->glyph_index_length = header->glyph_index_length;
+    font->glyph_table_length = header->glyph_table_length;
+    font->glyph_index = (FGlyphRange *) (data + sizeof(FFontHeader));
+    font->glyph_table = (FGlyph *) (font->glyph_index + font->glyph_index_length);
+    font->path_data = font->glyph_table + font->glyph_table_length;
+    return font;
+}
+
+void ffont_destroy(FFont *font) {
+    if (!font) return;
+    // the glyph index sits right after the header in the one allocation
+    free((uint8_t *) font->glyph_index - sizeof(FFontHeader));
+    free(font);
+}
+
+FGlyph *ffont_glyph_info(FFont *font, uint16_t unicode) {
+    uint16_t index = 0;
+    for (uint16_t i = 0; i < font->glyph_index_length; i++) {
+        FGlyphRange *range = &font->glyph_index[i];
+        if (unicode >= range->begin && unicode < range->end) return &font->glyph_table[index + unicode - range->begin];
+        index += range->end - range->begin;
+    }
+    return NULL;
+}
+
+void *ffont_glyph_outline(FFont *font, FGlyph *glyph) {
+    return (uint8_t *) font->path_data + glyph->path_data_offset;
+}
+
+FPath *fpath_create_from_resource(uint32_t resource_id) {
+    ResHandle handle = resource_get_handle(resource_id);
+    size_t size = resource_size(handle);
+    if (size == 0) return NULL;
+    FPath *fpath = malloc(sizeof(FPath));
+    if (!fpath) return NULL;
+    fpath->data = malloc(size);
+    if (!fpath->data) {
+        free(fpath);
+        return NULL;
+    }
+    fpath->size = resource_load(handle, fpath->data, size);
+    return fpath;
+}
+
+void fpath_destroy(FPath *fpath) {
+    if (!fpath) return;
+    free(fpath->data);
+    free(fpath);
+}
+
+// Context
+
+void fctx_init_context(FContext *fctx, GContext *gctx) {
+    memset(fctx, 0, sizeof(FContext));
+    fctx->gctx = gctx;
+    fctx->fill_color = GColorWhite;
+    fctx->scale_from = FPointOne;
+    fctx->scale_to = FPointOne;
+}
+
+void fctx_deinit_context(FContext *fctx) {
+}
+
+void fctx_set_fill_color(FContext *fctx, GColor c) {
+    fctx->fill_color = c;
+}
+
+void fctx_set_offset(FContext *fctx, FPoint offset) {
+    fctx->offset = offset;
+}
+
+void fctx_set_scale(FContext *fctx, FPoint scale_from, FPoint scale_to) {
+    fctx->scale_from = scale_from;
+    fctx->scale_to = scale_to;
+}
+
+void fctx_set_rotation(FContext *fctx, uint32_t rotation) {
+    fctx->rotation = rotation;
+}
+
+// Edges, in pixels
+
+typedef struct {
+    float x0, y0, x1, y1;
+    int8_t winding;
+} HostEdge;
+
+static HostEdge s_edges[HOST_FCTX_MAX_EDGES];
+static uint16_t s_edge_count;
+static float s_pen_x, s_pen_y;
+static float s_start_x, s_start_y;
+
+static void prv_transform(FContext *fctx, FPoint p, float *x, float *y) {
+    *x = ((float) p.x * fctx->scale_to.x / fctx->scale_from.x + fctx->offset.x) / FIXED_POINT_SCALE;
+    *y = ((float) p.y * fctx->scale_to.y / fctx->scale_from.y + fctx->offset.y) / FIXED_POINT_SCALE;
+}
+
+static void prv_edge(float x1, float y1) {
+    if (y1 != s_pen_y && s_edge_count < HOST_FCTX_MAX_EDGES) {
+        HostEdge *edge = &s_edges[s_edge_count++];
+        if (y1 > s_pen_y) *edge = (HostEdge) { s_pen_x, s_pen_y, x1, y1, 1 };
+        else *edge = (HostEdge) { x1, y1, s_pen_x, s_pen_y, -1 };
+    }
+    s_pen_x = x1;
+    s_pen_y = y1;
+}
+
+void fctx_begin_fill(FContext *fctx) {
+    s_edge_count = 0;
+    s_pen_x = s_pen_y = s_start_x = s_start_y = 0;
+    fctx->filling = true;
+}
+
+void fctx_move_to(FContext *fctx, FPoint p) {
+    if (s_pen_x != s_start_x || s_pen_y != s_start_y) prv_edge(s_start_x, s_start_y);
+    prv_transform(fctx, p, &s_pen_x, &s_pen_y);
+    s_start_x = s_pen_x;
+    s_start_y = s_pen_y;
+    fctx->path_start = p;
+    fctx->path_current = p;
+}
+
+void fctx_line_to(FContext *fctx, FPoint p) {
+    float x, y;
+    prv_transform(fctx, p, &x, &y);
+    prv_edge(x, y);
+    fctx->path_current = p;
+}
+
+void fctx_close_path(FContext *fctx) {
+    prv_edge(s_start_x, s_start_y);
+    fctx->path_current = fctx->path_start;
+}
+
+static void prv_curve_to(FContext *fctx, FPoint c1, FPoint c2, FPoint p) {
+    float x0 = fctx->path_current.x, y0 = fctx->path_current.y;
+    for (int i = 1; i <= HOST_FCTX_CURVE_STEPS; i++) {
+        float t = (float) i / HOST_FCTX_CURVE_STEPS;
+        float u = 1 - t;
+        FPoint q = {
+            u * u * u * x0 + 3 * u * u * t * c1.x + 3 * u * t * t * c2.x + t * t * t * p.x,
+            u * u * u * y0 + 3 * u * u * t * c1.y + 3 * u * t * t * c2.y + t * t * t * p.y
+        };
+        float x, y;
+        prv_transform(fctx, q, &x, &y);
+        prv_edge(x, y);
+    }
+    fctx->path_current = p;
+}
+
+static void prv_quad_to(FContext *fctx, FPoint c, FPoint p) {
+    FPoint p0 = fctx->path_current;
+    FPoint c1 = { p0.x + 2 * (c.x - p0.x) / 3, p0.y + 2 * (c.y - p0.y) / 3 };
+    FPoint c2 = { p.x + 2 * (c.x - p.x) / 3, p.y + 2 * (c.y - p.y) / 3 };
+    prv_curve_to(fctx, c1, c2, p);
+}
+
+static void prv_plot(GBitmap *fb, int16_t x, int16_t y, GColor color, float coverage) {
+    uint8_t *row = gbitmap_get_data(fb) + y * gbitmap_get_bytes_per_row(fb);
+    if (gbitmap_get_format(fb) == GBitmapFormat1Bit) {
+        if (coverage < 0.5f) return;
+        if (color.r + color.g + color.b >= 5) row[x / 8] |= 1 << (x % 8);
+        else row[x / 8] &= ~(1 << (x % 8));
+        return;
+    }
+    uint8_t alpha = (uint8_t) (coverage * 3 + 0.5f);
+    if (alpha == 0) return;
+    GColor dst = { .argb = row[x] };
+    GColor out = GColorBlack;
+    out.r = (dst.r * (3 - alpha) + color.r * alpha + 1) / 3;
+    out.g = (dst.g * (3 - alpha) + color.g * alpha + 1) / 3;
+    out.b = (dst.b * (3 - alpha) + color.b * alpha + 1) / 3;
+    row[x] = out.argb;
+}
+
+void fctx_end_fill(FContext *fctx) {
+    if (s_pen_x != s_start_x || s_pen_y != s_start_y) prv_edge(s_start_x, s_start_y);
+    fctx->filling = false;
+    if (s_edge_count == 0 || fctx->fill_color.a == 0) return;
+
+    GBitmap *fb = graphics_capture_frame_buffer(fctx->gctx);
+    if (!fb) return;
+    GRect clip = gbitmap_get_bounds(fb);
+    int16_t clip_x1 = clip.origin.x + clip.size.w;
+    if (clip_x1 > HOST_FCTX_MAX_WIDTH) clip_x1 = HOST_FCTX_MAX_WIDTH;
+
+    float top = s_edges[0].y0, bottom = s_edges[0].y1;
+    for (uint16_t i = 1; i < s_edge_count; i++) {
+        if (s_edges[i].y0 < top) top = s_edges[i].y0;
+        if (s_edges[i].y1 > bottom) bottom = s_edges[i].y1;
+    }
+    int16_t y_begin = top < clip.origin.y ? clip.origin.y : (int16_t) top;
+    int16_t y_end = bottom > clip.origin.y + clip.size.h ? clip.origin.y + clip.size.h : (int16_t) bottom + 1;
+
+    static float coverage[HOST_FCTX_MAX_WIDTH];
+    static float crossings[HOST_FCTX_MAX_EDGES];
+    static int8_t windings[HOST_FCTX_MAX_EDGES];
+    uint32_t pixels = 0;
+    for (int16_t y = y_begin; y < y_end; y++) {
+        int16_t span_x0 = clip_x1, span_x1 = -1;
+        memset(coverage, 0, sizeof(coverage));
+        for (int s = 0; s < HOST_FCTX_SUBSAMPLES; s++) {
+            float sy = y + (s + 0.5f) / HOST_FCTX_SUBSAMPLES;
+            uint16_t count = 0;
+            for (uint16_t i = 0; i < s_edge_count; i++) {
+                HostEdge *edge = &s_edges[i];
+                if (sy < edge->y0 || sy >= edge->y1) continue;
+                float x = edge->x0 + (sy - edge->y0) * (edge->x1 - edge->x0) / (edge->y1 - edge->y0);
+                uint16_t j = count++;
+                for (; j > 0 && crossings[j - 1] > x; j--) {
+                    crossings[j] = crossings[j - 1];
+                    windings[j] = windings[j - 1];
+                }
+                crossings[j] = x;
+                windings[j] = edge->winding;
+            }
+
+            int winding = 0;
+            for (uint16_t i = 0; i + 1 < count; i++) {
+                winding += windings[i];
+                if (winding == 0) continue;
+                float xa = crossings[i] < clip.origin.x ? clip.origin.x : crossings[i];
+                float xb = crossings[i + 1] > clip_x1 ? clip_x1 : crossings[i + 1];
+                for (int16_t x = (int16_t) xa; x < xb; x++) {
+                    float left = xa > x ? xa : x;
+                    float right = xb < x + 1 ? xb : x + 1;
+                    coverage[x] += (right - left) / HOST_FCTX_SUBSAMPLES;
+                    if (x < span_x0) span_x0 = x;
+                    if (x > span_x1) span_x1 = x;
+                }
+            }
+        }
+        for (int16_t x = span_x0; x <= span_x1; x++) {
+            if (coverage[x] <= 0) continue;
+            prv_plot(fb, x, y, fctx->fill_color, coverage[x] > 1 ? 1 : coverage[x]);
+            pixels++;
+        }
+        if (span_x1 >= span_x0) host_touch(GRect(span_x0, y, span_x1 - span_x0 + 1, 1));
+    }
+    graphics_release_frame_buffer(fctx->gctx, fb);
+    host_count_fill(pixels);
+}
+
+// Path commands: an int16 code, then int16 12.4 fixed arguments
+
+void fctx_draw_commands(FContext *fctx, FPoint advance, void *path_data, uint16_t length) {
+    int16_t *cmd = path_data;
+    int16_t *end = (int16_t *) ((uint8_t *) path_data + length);
+    FPoint control = fctx->path_current;
+    char last = 0;
+    while (cmd < end) {
+        char code = *cmd++;
+        FPoint current = fctx->path_current;
+        switch (code) {
+            case 'M':
+                fctx_move_to(fctx, (FPoint) { cmd[0] + advance.x, cmd[1] + advance.y });
+                cmd += 2;
+                break;
+            case 'L':
+                fctx_line_to(fctx, (FPoint) { cmd[0] + advance.x, cmd[1] + advance.y });
+                cmd += 2;
+                break;
+            case 'H':
+                fctx_line_to(fctx, (FPoint) { cmd[0] + advance.x, current.y });
+                cmd += 1;
+                break;
+            case 'V':
+                fctx_line_to(fctx, (FPoint) { current.x, cmd[0] + advance.y });
+                cmd += 1;
+                break;
+            case 'Q':
+                control = (FPoint) { cmd[0] + advance.x, cmd[1] + advance.y };
+                prv_quad_to(fctx, control, (FPoint) { cmd[2] + advance.x, cmd[3] + advance.y });
+                cmd += 4;
+                break;
+            case 'T':
+                control = (last == 'Q' || last == 'T') ?
+                          (FPoint) { 2 * current.x - control.x, 2 * current.y - control.y } : current;
+                prv_quad_to(fctx, control, (FPoint) { cmd[0] + advance.x, cmd[1] + advance.y });
+                cmd += 2;
+                break;
+            case 'C': {
+                FPoint c1 = { cmd[0] + advance.x, cmd[1] + advance.y };
+                control = (FPoint) { cmd[2] + advance.x, cmd[3] + advance.y };
+                prv_curve_to(fctx, c1, control, (FPoint) { cmd[4] + advance.x, cmd[5] + advance.y });
+                cmd += 6;
+                break;
+            }
+            case 'S': {
+                FPoint c1 = (last == 'C' || last == 'S') ?
+                            (FPoint) { 2 * current.x - control.x, 2 * current.y - control.y } : current;
+                control = (FPoint) { cmd[0] + advance.x, cmd[1] + advance.y };
+                prv_curve_to(fctx, c1, control, (FPoint) { cmd[2] + advance.x, cmd[3] + advance.y });
+                cmd += 4;
+                break;
+            }
+            case 'Z':
+                fctx_close_path(fctx);
+                break;
+            default:
+                APP_LOG(APP_LOG_LEVEL_ERROR, "unknown path command %d", code);
+                return;
+        }
+        last = code;
+    }
+}
+
+// Text
+
+void fctx_set_text_em_height(FContext *fctx, FFont *font, int16_t pixels) {
+    fctx->scale_from = (FPoint) { font->units_per_em, -font->units_per_em };
+    fctx->scale_to = FPointI(pixels, pixels);
+}
+
+static uint16_t prv_next_char(const char **text) {
+    const uint8_t *c = (const uint8_t *) *text;
+    if (c[0] < 0x80) {
+        *text += 1;
+        return c[0];
+    }
+    if ((c[0] & 0xe0) == 0xc0 && c[1]) {
+        *text += 2;
+        return ((c[0] & 0x1f) << 6) | (c[1] & 0x3f);
+    }
+    if ((c[0] & 0xf0) == 0xe0 && c[1] && c[2]) {
+        *text += 3;
+        return ((c[0] & 0x0f) << 12) | ((c[1] & 0x3f) << 6) | (c[2] & 0x3f);
+    }
+    *text += 1;
+    return '?';
+}
+
+static fixed_t prv_string_advance(const char *text, FFont *font) {
+    fixed_t width = 0;
+    while (*text) {
+        FGlyph *glyph = ffont_glyph_info(font, prv_next_char(&text));
+        if (glyph) width += glyph->horiz_adv_x;
+    }
+    return width;
+}
+
+fixed_t fctx_string_width(FContext *fctx, const char *text, FFont *font) {
+    return prv_string_advance(text, font) * fctx->scale_to.x / fctx->scale_from.x;
+}
+
+void fctx_draw_string(FContext *fctx, const char *text, FFont *font, GTextAlignment alignment, FTextAnchor anchor) {
+    FPoint advance = FPointZero;
+    if (alignment == GTextAlignmentCenter) advance.x = -prv_string_advance(text, font) / 2;
+    else if (alignment == GTextAlignmentRight) advance.x = -prv_string_advance(text, font);
+
+    switch (anchor) {
+        case FTextAnchorBaseline: break;
+        case FTextAnchorMiddle: advance.y = -(font->ascent + font->descent) / 2; break;
+        case FTextAnchorTop: advance.y = -font->ascent; break;
+        case FTextAnchorBottom: advance.y = -font->descent; break;
+        case FTextAnchorCapMiddle: advance.y = -font->cap_height / 2; break;
+        case FTextAnchorCapTop: advance.y = -font->cap_height; break;
+    }
+
+    while (*text) {
+        FGlyph *glyph = ffont_glyph_info(font, prv_next_char(&text));
+        if (!glyph) continue;
+        fctx_draw_commands(fctx, advance, ffont_glyph_outline(font, glyph), glyph->path_data_length);
+        advance.x += glyph->horiz_adv_x;
+    }
+}
@@ -0,0 +1,155 @@
+// Drives the face the way the watch would: the face's own main runs, and its
+// app_event_loop hands over to a scenario that advances the clock. Ticks and
+// timers fire in order as the clock passes them, each followed by a render.
+#include <pebble.h>
+#include "host.h"
+#include "heap-account.h"
+
+static HostScenario s_scenario;
+static uint64_t s_last_tick_ms;
+static uint64_t s_run_cycles;
+static uint64_t s_startup_cycles;
+
+// Fires whatever is due next by until_ms, the timer first when it coincides with a tick
+static bool prv_step(uint64_t until_ms) {
+    TimeUnits units = host_tick_units();
+    uint64_t period = (units & SECOND_UNIT) ? 1000 : (units & MINUTE_UNIT) ? 60000 : (units & HOUR_UNIT) ? 3600000 : 86400000;
+    uint64_t tick_ms = (s_last_tick_ms / period + 1) * period;
+    uint64_t timer_ms;
+    bool has_timer = host_next_timer_due(&timer_ms);
+
+    if (has_timer && timer_ms <= tick_ms && timer_ms <= until_ms) return host_fire_next_timer(until_ms);
+    if (tick_ms > until_ms) return false;
+
+    uint64_t now = host_now_ms();
+    if (tick_ms > now) host_skip_ms(tick_ms - now);
+    s_last_tick_ms = tick_ms;
+    time_t seconds = tick_ms / 1000;
+    struct tm tick_time = *localtime(&seconds);
+    TimeUnits changed = SECOND_UNIT;
+    if (tick_time.tm_sec == 0) changed |= MINUTE_UNIT;
+    if (tick_time.tm_sec == 0 && tick_time.tm_min == 0) changed |= HOUR_UNIT;
+    if (tick_time.tm_sec == 0 && tick_time.tm_min == 0 && tick_time.tm_hour == 0) changed |= DAY_UNIT;
+    host_fire_tick(&tick_time, changed);
+    return true;
+}
+
+void host_advance(uint64_t ms) {
+    uint64_t until_ms = host_now_ms() + ms;
+    while (prv_step(until_ms)) host_render();
+    uint64_t now = host_now_ms();
+    if (until_ms > now) host_skip_ms(until_ms - now);
+    host_render();
+}
+
+// Runs up to and including the next tick that changes unit
+void host_advance_to(TimeUnits unit) {
+    uint64_t period = unit == SECOND_UNIT ? 1000 : unit == MINUTE_UNIT ? 60000 : unit == HOUR_UNIT ? 3600000 : 86400000;
+    uint64_t now = host_now_ms();
+    host_advance((now / period + 1) * period - now);
+}
+
+void app_event_loop(void) {
+    s_last_tick_ms = host_now_ms();
+    // the first frame goes out once init returns, like on the watch
+    host_render();
+    s_startup_cycles = host_cycles() - s_run_cycles;
+    if (s_scenario) s_scenario();
+}
+
+// False when the face went over its heap budget at any point, deinit included
+bool host_run(HostScenario scenario) {
+    host_sdk_init();
+    s_scenario = scenario;
+    s_run_cycles = host_cycles();
+    pebble_main();
+    size_t high_water = host_heap_stats().high_water;
+    if (high_water <= HEAP_ACCOUNT_BUDGET) return true;
+    printf("FAIL heap peak %zu over the %d budget\n", high_water, HEAP_ACCOUNT_BUDGET);
+    return false;
+}
+
+// From entering the face's main to the first frame being rendered, init included
+uint64_t host_startup_cycles(void) {
+    return s_startup_cycles;
+}
+
+size_t host_dict_add(uint8_t *dict, size_t length, uint32_t key, TupleType type, const void *data, uint16_t size) {
+    Tuple *tuple = (Tuple *) (dict + length);
+    tuple->key = key;
+    tuple->type = type;
+    tuple->length = size;
+    memcpy(tuple->value->data, data, size);
+    return length + sizeof(Tuple) + size;
+}
+
+static uint16_t prv_minutes_after(time_t t, time_t midnight) {
+    return (t - midnight) / SECONDS_PER_MINUTE;
+}
+
+// WEATHER_COMPACT as packWeather in src/pkjs/index.js sends it
+size_t host_pack_weather(uint8_t *buf, const GenericWeatherInfo *info) {
+    time_t timestamp = info->timestamp;
+    struct tm *local = localtime(&timestamp);
+    time_t midnight = timestamp - (local->tm_hour * SECONDS_PER_HOUR + local->tm_min * SECONDS_PER_MINUTE + local->tm_sec);
+    uint16_t sunrise = prv_minutes_after(info->timesunrise, midnight);
+    uint16_t sunset = prv_minutes_after(info->timesunset, midnight);
+
+    buf[0] = 1;
+    buf[1] = info->day ? 1 : 0;
+    buf[2] = info->condition <= GenericWeatherConditionMist ? info->condition : 0xff;
+    buf[3] = info->temp_c;
+    buf[4] = info->temp_f;
+    buf[5] = info->temp_feels_like_c;
+    buf[6] = info->temp_feels_like_f;
+    buf[7] = info->temp_low_c;
+    buf[8] = info->temp_low_f;
+    buf[9] = info->temp_high_c;
+    buf[10] = info->temp_high_f;
+    buf[11] = info->humidity;
+    buf[12] = sunrise & 0xff;
+    buf[13] = sunrise >> 8;
+    buf[14] = sunset & 0xff;
+    buf[15] = sunset >> 8;
+    for (int i = 0; i < 4; i++) buf[16 + i] = (uint32_t) timestamp >> (8 * i);
+    return 20;
+}
+
+void host_send_weather(const GenericWeatherInfo *info) {
+    uint8_t payload[20];
+    uint8_t dict[64];
+    size_t length = host_dict_add(dict, 0, MESSAGE_KEY_WEATHER_COMPACT, TUPLE_BYTE_ARRAY, payload, host_pack_weather(payload, info));
+    host_inbox(dict, length);
+    host_render();
+}
+
+// WEATHER_FORECAST as packForecast in src/pkjs/index.js sends it, every hour the same
+void host_send_forecast(time_t start, uint8_t hours, const GenericWeatherInfo *hour) {
+    uint8_t payload[6 + 24 * 4];
+    uint8_t dict[160];
+    if (hours > 24) hours = 24;
+    payload[0] = 1;
+    payload[1] = hours;
+    for (int i = 0; i < 4; i++) payload[2 + i] = (uint32_t) start >> (8 * i);
+    for (uint8_t i = 0; i < hours; i++) {
+        uint8_t *packed = &payload[6 + i * 4];
+        packed[0] = hour->temp_c;
+        packed[1] = hour->temp_f;
+        packed[2] = hour->condition <= GenericWeatherConditionMist ? hour->condition : 0xff;
+        packed[3] = hour->day ? 1 : 0;
+    }
+    size_t length = host_dict_add(dict, 0, MESSAGE_KEY_WEATHER_FORECAST, TUPLE_BYTE_ARRAY, payload, 6 + hours * 4);
+    host_inbox(dict, length);
+    host_render();
+}
+
+// What the phone sends once its JS is up, with the weather it has cached if any
+void host_send_app_ready(const GenericWeatherInfo *cached) {
+    uint8_t ready = 1;
+    uint8_t payload[20];
+    uint8_t dict[64];
+    size_t length = host_dict_add(dict, 0, MESSAGE_KEY_APP_READY, TUPLE_UINT, &ready, sizeof(ready));
+    if (cached) length = host_dict_add(dict, length, MESSAGE_KEY_WEATHER_COMPACT, TUPLE_BYTE_ARRAY, payload, host_pack_weather(payload, cached));
+    host_inbox(dict, length);
+    host_render();
+}
@@ -0,0 +1,90 @@
+#pragma once
+// What the host programs use to drive the face, on top of the stand-in SDK in include/.
+#include <pebble.h>
+#include <pebble-generic-weather/pebble-generic-weather.h>
+#include <pebble-geocode-mapquest/pebble-geocode-mapquest.h>
+
+// Heap budgets the face has to stay under, see src/c/heap-account.h
+typedef struct {
+    size_t used;
+    size_t peak;
+    // peak since start, which host_heap_reset_peak leaves alone
+    size_t high_water;
+    uint32_t allocs;
+    uint32_t frees;
+} HostHeapStats;
+
+HostHeapStats host_heap_stats(void);
+void host_heap_reset_peak(void);
+
+// Frames rendered since the last host_frame_stats_reset
+typedef struct {
+    uint32_t frames;
+    uint64_t cycles;
+    uint64_t max_cycles;
+    uint32_t allocs;
+    uint32_t fills;
+    uint32_t blits;
+    uint32_t pixels;
+    // union of every frame buffer pixel written, in screen coordinates
+    GRect touched;
+} HostFrameStats;
+
+HostFrameStats host_frame_stats(void);
+void host_frame_stats_reset(void);
+uint64_t host_cycles(void);
+
+// sdk.c
+void host_sdk_init(void);
+uint64_t host_now_ms(void);
+void host_skip_ms(uint64_t ms);
+bool host_next_timer_due(uint64_t *due_ms);
+bool host_fire_next_timer(uint64_t until_ms);
+bool host_render(void);
+bool host_needs_render(void);
+GBitmap *host_frame_buffer(void);
+GContext *host_graphics_context(void);
+bool host_dump_frame(const char *path);
+void host_count_fill(uint32_t pixels);
+void host_touch(GRect rect);
+void host_touch_pixel(int16_t x, int16_t y);
+uint32_t host_log_count(uint8_t level);
+void host_log_set_level(uint8_t level);
+void host_persist_reset(void);
+uint32_t host_persist_write_count(void);
+uint32_t host_persist_write_bytes(void);
+void host_battery_set(BatteryChargeState state);
+void host_connection_set(bool connected);
+
+// packages.c
+void host_fire_tick(struct tm *tick_time, TimeUnits units_changed);
+TimeUnits host_tick_units(void);
+void host_fire_tap(void);
+void host_fire_battery(void);
+void host_fire_connection(void);
+#ifdef PBL_HEALTH
+void host_fire_health(HealthEventType event);
+#endif
+void host_inbox(const uint8_t *dict, size_t length);
+void host_settings_set(const char *key, const char *value);
+void host_settings_apply(void);
+uint32_t host_weather_fetch_count(void);
+GenericWeatherInfo host_sample_weather(time_t timestamp);
+void host_weather_reply(const GenericWeatherInfo *info, GenericWeatherStatus status);
+GenericWeatherCoordinates host_weather_location(void);
+uint32_t host_geocode_fetch_count(void);
+void host_geocode_reply(const GeocodeMapquestCoordinates *coordinates, GeocodeMapquestStatus status);
+
+// harness.c, host_run calls the face's main, which calls scenario from app_event_loop,
+// and fails the run when the heap went over HEAP_ACCOUNT_BUDGET
+typedef void (*HostScenario)(void);
+int pebble_main(void);
+bool host_run(HostScenario scenario);
+uint64_t host_startup_cycles(void);
+void host_advance(uint64_t ms);
+void host_advance_to(TimeUnits unit);
+size_t host_dict_add(uint8_t *dict, size_t length, uint32_t key, TupleType type, const void *data, uint16_t size);
+size_t host_pack_weather(uint8_t *buf, const GenericWeatherInfo *info);
+void host_send_weather(const GenericWeatherInfo *info);
+void host_send_app_ready(const GenericWeatherInfo *cached);
+void host_send_forecast(time_t start, uint8_t hours, const GenericWeatherInfo *hour);
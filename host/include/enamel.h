@@ -0,0 +1,33 @@
+#pragma once
+// Stand-in for the header enamel generates from src/pkjs/config.json, implemented by
+// host/packages.c. Values start at the config.json defaults, see host_settings_set.
+#include <pebble.h>
+#include <pebble-events/pebble-events.h>
+
+typedef void (*EnamelSettingsReceivedHandler)(void *context);
+
+void enamel_init(void);
+void enamel_deinit(void);
+EventHandle enamel_settings_received_subscribe(EnamelSettingsReceivedHandler handler, void *context);
+void enamel_settings_received_unsubscribe(EventHandle handle);
+
+bool enamel_get_LEADING_ZERO(void);
+GColor enamel_get_COLOR_BACKGROUND(void);
+GColor enamel_get_COLOR_TEXT(void);
+GColor enamel_get_COLOR_PINLINE(void);
+bool enamel_get_HOURLY_VIBE(void);
+const char *enamel_get_CONNECTION_VIBE(void);
+const char *enamel_get_WIDGET_NW(void);
+const char *enamel_get_WIDGET_NE(void);
+const char *enamel_get_WIDGET_SW(void);
+const char *enamel_get_WIDGET_SE(void);
+bool enamel_get_EXTRA_WIDGETS_ENABLED(void);
+const char *enamel_get_EXTRA_WIDGET_NW(void);
+const char *enamel_get_EXTRA_WIDGET_NE(void);
+const char *enamel_get_EXTRA_WIDGET_SW(void);
+const char *enamel_get_EXTRA_WIDGET_SE(void);
+const char *enamel_get_HEALTH_INTERVAL(void);
+const char *enamel_get_WEATHER_UNIT(void);
+bool enamel_get_WEATHER_USE_GPS(void);
+const char *enamel_get_WEATHER_LOCATION_NAME(void);
+const char *enamel_get_WEATHER_INTERVAL(void);
@@ -0,0 +1,10 @@
+#pragma once
+// Stand-in for pebble-connection-vibes, implemented by host/packages.c
+#include <pebble.h>
+
+void connection_vibes_init(void);
+void connection_vibes_deinit(void);
+void connection_vibes_set_state(uint8_t state);
+#ifdef PBL_HEALTH
+void connection_vibes_enable_health(bool enable);
+#endif
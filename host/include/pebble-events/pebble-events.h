@@ -0,0 +1,33 @@
+#pragma once
+// Stand-in for pebble-events, implemented by host/packages.c
+#include <pebble.h>
+
+typedef void *EventHandle;
+
+typedef struct {
+    AppMessageInboxReceived received;
+    AppMessageInboxDropped dropped;
+    AppMessageOutboxSent sent;
+    AppMessageOutboxFailed failed;
+} EventAppMessageHandlers;
+
+EventHandle events_tick_timer_service_subscribe(TimeUnits tick_units, TickHandler handler);
+void events_tick_timer_service_unsubscribe(EventHandle handle);
+
+EventHandle events_battery_state_service_subscribe(BatteryStateHandler handler);
+void events_battery_state_service_unsubscribe(EventHandle handle);
+
+EventHandle events_connection_service_subscribe(ConnectionHandlers conn_handlers);
+void events_connection_service_unsubscribe(EventHandle handle);
+
+EventHandle events_accel_tap_service_subscribe(AccelTapHandler handler);
+void events_accel_tap_service_unsubscribe(EventHandle handle);
+
+#ifdef PBL_HEALTH
+EventHandle events_health_service_events_subscribe(HealthEventHandler handler, void *context);
+void events_health_service_events_unsubscribe(EventHandle handle);
+#endif
+
+void events_app_message_open(void);
+EventHandle events_app_message_subscribe_handlers(EventAppMessageHandlers handlers, void *context);
+void events_app_message_unsubscribe(EventHandle handle);
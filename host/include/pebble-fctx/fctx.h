@@ -0,0 +1,64 @@
+#pragma once
+// Stand-in for pebble-fctx's fctx.h, implemented by host/fctx.c: a scanline fill with
+// four samples per row, nonzero winding and coverage blended into the frame buffer.
+// Only the calls src/c makes; rotation is accepted but ignored.
+#include <pebble.h>
+#include "ffont.h"
+
+typedef int32_t fixed_t;
+
+#define FIXED_POINT_SHIFT 4
+#define FIXED_POINT_SCALE 16
+#define INT_TO_FIXED(a) ((a) * FIXED_POINT_SCALE)
+#define FIXED_TO_INT(a) ((a) / FIXED_POINT_SCALE)
+
+typedef struct FPoint {
+    fixed_t x;
+    fixed_t y;
+} FPoint;
+
+#define FPoint(x, y) ((FPoint) { INT_TO_FIXED(x), INT_TO_FIXED(y) })
+#define FPointI(x, y) ((FPoint) { INT_TO_FIXED(x), INT_TO_FIXED(y) })
+#define FPointZero FPointI(0, 0)
+#define FPointOne FPointI(1, 1)
+
+static inline FPoint g2fpoint(GPoint point) {
+    return FPointI(point.x, point.y);
+}
+
+typedef enum {
+    FTextAnchorBaseline,
+    FTextAnchorMiddle,
+    FTextAnchorTop,
+    FTextAnchorBottom,
+    FTextAnchorCapMiddle,
+    FTextAnchorCapTop
+} FTextAnchor;
+
+typedef struct FContext {
+    GContext *gctx;
+    GColor fill_color;
+    FPoint offset;
+    FPoint scale_from;
+    FPoint scale_to;
+    int32_t rotation;
+    FPoint path_start;
+    FPoint path_current;
+    bool filling;
+} FContext;
+
+void fctx_init_context(FContext *fctx, GContext *gctx);
+void fctx_deinit_context(FContext *fctx);
+void fctx_set_fill_color(FContext *fctx, GColor c);
+void fctx_set_offset(FContext *fctx, FPoint offset);
+void fctx_set_scale(FContext *fctx, FPoint scale_from, FPoint scale_to);
+void fctx_set_rotation(FContext *fctx, uint32_t rotation);
+void fctx_begin_fill(FContext *fctx);
+void fctx_end_fill(FContext *fctx);
+void fctx_move_to(FContext *fctx, FPoint p);
+void fctx_line_to(FContext *fctx, FPoint p);
+void fctx_close_path(FContext *fctx);
+void fctx_draw_commands(FContext *fctx, FPoint advance, void *path_data, uint16_t length);
+void fctx_set_text_em_height(FContext *fctx, FFont *font, int16_t pixels);
+fixed_t fctx_string_width(FContext *fctx, const char *text, FFont *font);
+void fctx_draw_string(FContext *fctx, const char *text, FFont *font, GTextAlignment alignment, FTextAnchor anchor);
@@ -0,0 +1,34 @@
+#pragma once
+// Stand-in for pebble-fctx's ffont.h, implemented by host/fctx.c. Same file format:
+// a header of 12.4 fixed metrics, the character ranges, a glyph table and the outlines.
+#include <pebble.h>
+
+typedef int16_t fixed16_t;
+
+typedef struct __attribute__((__packed__)) FGlyphRange {
+    uint16_t begin;
+    uint16_t end;
+} FGlyphRange;
+
+typedef struct __attribute__((__packed__)) FGlyph {
+    uint16_t path_data_offset;
+    uint16_t path_data_length;
+    fixed16_t horiz_adv_x;
+} FGlyph;
+
+typedef struct FFont {
+    fixed16_t units_per_em;
+    fixed16_t ascent;
+    fixed16_t descent;
+    fixed16_t cap_height;
+    uint16_t glyph_index_length;
+    uint16_t glyph_table_length;
+    FGlyphRange *glyph_index;
+    FGlyph *glyph_table;
+    void *path_data;
+} FFont;
+
+FFont *ffont_create_from_resource(uint32_t resource_id);
+void ffont_destroy(FFont *font);
+FGlyph *ffont_glyph_info(FFont *font, uint16_t unicode);
+void *ffont_glyph_outline(FFont *font, FGlyph *glyph);
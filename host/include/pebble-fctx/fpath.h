@@ -0,0 +1,11 @@
+#pragma once
+// Stand-in for pebble-fctx's fpath.h, implemented by host/fctx.c
+#include <pebble.h>
+
+typedef struct FPath {
+    uint16_t size;
+    void *data;
+} FPath;
+
+FPath *fpath_create_from_resource(uint32_t resource_id);
+void fpath_destroy(FPath *fpath);
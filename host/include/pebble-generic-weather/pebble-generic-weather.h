@@ -0,0 +1,72 @@
+#pragma once
+// Stand-in for the pebble-generic-weather fork, implemented by host/packages.c.
+// Fetches complete when the harness replies, see host_weather_reply.
+#include <pebble.h>
+
+typedef enum {
+    GenericWeatherConditionClearSky = 0,
+    GenericWeatherConditionScatteredClouds,
+    GenericWeatherConditionFewClouds,
+    GenericWeatherConditionBrokenClouds,
+    GenericWeatherConditionShowerRain,
+    GenericWeatherConditionRain,
+    GenericWeatherConditionThunderstorm,
+    GenericWeatherConditionSnow,
+    GenericWeatherConditionMist,
+    GenericWeatherConditionUnknown = 1000
+} GenericWeatherConditionCode;
+
+typedef enum {
+    GenericWeatherStatusNotYetFetched = 0,
+    GenericWeatherStatusBluetoothDisconnected,
+    GenericWeatherStatusPending,
+    GenericWeatherStatusFailed,
+    GenericWeatherStatusAvailable,
+    GenericWeatherStatusBadKey,
+    GenericWeatherStatusLocationUnavailable
+} GenericWeatherStatus;
+
+typedef enum {
+    GenericWeatherProviderOpenWeatherMap = 0,
+    GenericWeatherProviderWeatherUnderground,
+    GenericWeatherProviderForecastIo
+} GenericWeatherProvider;
+
+typedef struct {
+    int32_t latitude;
+    int32_t longitude;
+} GenericWeatherCoordinates;
+
+#define GENERIC_WEATHER_GPS_LOCATION ((GenericWeatherCoordinates) { .latitude = (int32_t) 0xffffffff, .longitude = (int32_t) 0xffffffff })
+
+typedef struct {
+    int16_t temp_k;
+    int16_t temp_c;
+    int16_t temp_f;
+    int16_t temp_feels_like_c;
+    int16_t temp_feels_like_f;
+    int16_t temp_low_c;
+    int16_t temp_low_f;
+    int16_t temp_high_c;
+    int16_t temp_high_f;
+    uint8_t humidity;
+    char name[32];
+    char description[32];
+    GenericWeatherConditionCode condition;
+    time_t timestamp;
+    bool day;
+    time_t timesunrise;
+    time_t timesunset;
+} GenericWeatherInfo;
+
+typedef void (*GenericWeatherCallback)(GenericWeatherInfo *info, GenericWeatherStatus status);
+
+void generic_weather_init(void);
+void generic_weather_deinit(void);
+void generic_weather_set_api_key(const char *api_key);
+void generic_weather_set_provider(GenericWeatherProvider provider);
+void generic_weather_set_location(const GenericWeatherCoordinates coordinates);
+bool generic_weather_fetch(GenericWeatherCallback callback);
+GenericWeatherInfo *generic_weather_peek(void);
+void generic_weather_save(const uint32_t key);
+void generic_weather_load(const uint32_t key);
@@ -0,0 +1,28 @@
+#pragma once
+// Stand-in for pebble-geocode-mapquest, implemented by host/packages.c
+#include <pebble.h>
+
+#define GEOCODE_MAPQUEST_MAX_LOCATION_LEN 64
+
+typedef enum {
+    GeocodeMapquestStatusNotYetFetched = 0,
+    GeocodeMapquestStatusBluetoothDisconnected,
+    GeocodeMapquestStatusPending,
+    GeocodeMapquestStatusFailed,
+    GeocodeMapquestStatusAvailable
+} GeocodeMapquestStatus;
+
+typedef struct {
+    int32_t latitude;
+    int32_t longitude;
+} GeocodeMapquestCoordinates;
+
+typedef void (*GeocodeMapquestCallback)(GeocodeMapquestCoordinates *coordinates, GeocodeMapquestStatus status);
+
+void geocode_mapquest_init(void);
+void geocode_mapquest_deinit(void);
+void geocode_mapquest_set_api_key(const char *api_key);
+bool geocode_mapquest_fetch(const char *location, GeocodeMapquestCallback callback);
+GeocodeMapquestCoordinates *geocode_mapquest_peek(void);
+void geocode_mapquest_save(const uint32_t key);
+void geocode_mapquest_load(const uint32_t key);
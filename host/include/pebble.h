@@ -0,0 +1,462 @@
+#pragma once
+// Stand-in for the Pebble SDK header, just the part of it src/c uses, so the face
+// compiles and runs on Linux. Implemented by host/sdk.c over an in-memory frame buffer
+// and a virtual clock driven by host/harness.c.
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <locale.h>
+#include <sys/types.h>
+
+// the platform and its features come from the command line, as the SDK's build passes them,
+// so sources can test them before including anything, see host/Makefile
+#if !defined(PBL_PLATFORM_APLITE) && !defined(PBL_PLATFORM_BASALT) && !defined(PBL_PLATFORM_DIORITE)
+#error Define one of PBL_PLATFORM_APLITE, PBL_PLATFORM_BASALT or PBL_PLATFORM_DIORITE
+#endif
+
+#ifdef PBL_COLOR
+#define PBL_IF_COLOR_ELSE(if_true, if_false) (if_true)
+#else
+#define PBL_IF_COLOR_ELSE(if_true, if_false) (if_false)
+#endif
+#define PBL_DISPLAY_WIDTH 144
+#define PBL_DISPLAY_HEIGHT 168
+
+#define ARRAY_LENGTH(array) (sizeof((array)) / sizeof((array)[0]))
+
+// the face allocates through these, host/sdk.c counts every call against the platform heap
+void *host_malloc(size_t size);
+void *host_calloc(size_t count, size_t size);
+void *host_realloc(void *ptr, size_t size);
+void host_free(void *ptr);
+#define malloc host_malloc
+#define calloc host_calloc
+#define realloc host_realloc
+#define free host_free
+
+size_t heap_bytes_used(void);
+size_t heap_bytes_free(void);
+
+// Logging
+
+typedef enum {
+    APP_LOG_LEVEL_ERROR = 1,
+    APP_LOG_LEVEL_WARNING = 50,
+    APP_LOG_LEVEL_INFO = 100,
+    APP_LOG_LEVEL_DEBUG = 200,
+    APP_LOG_LEVEL_DEBUG_VERBOSE = 255
+} AppLogLevel;
+
+void app_log(uint8_t log_level, const char *src_filename, int src_line_number, const char *fmt, ...);
+#define APP_LOG(level, fmt, ...) app_log(level, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+
+// Time, on the harness clock
+
+#define SECONDS_PER_MINUTE 60
+#define SECONDS_PER_HOUR 3600
+#define SECONDS_PER_DAY 86400
+
+typedef enum {
+    SECOND_UNIT = 1 << 0,
+    MINUTE_UNIT = 1 << 1,
+    HOUR_UNIT = 1 << 2,
+    DAY_UNIT = 1 << 3,
+    MONTH_UNIT = 1 << 4,
+    YEAR_UNIT = 1 << 5
+} TimeUnits;
+
+time_t host_time(time_t *tloc);
+#define time host_time
+uint16_t time_ms(time_t *t_utc, uint16_t *out_ms);
+time_t time_start_of_today(void);
+bool clock_is_24h_style(void);
+
+typedef struct AppTimer AppTimer;
+typedef void (*AppTimerCallback)(void *data);
+AppTimer *app_timer_register(uint32_t timeout_ms, AppTimerCallback callback, void *callback_data);
+bool app_timer_reschedule(AppTimer *timer, uint32_t new_timeout_ms);
+void app_timer_cancel(AppTimer *timer);
+
+void app_event_loop(void);
+
+// Graphics types
+
+typedef union GColor8 {
+    uint8_t argb;
+    struct {
+        uint8_t b:2;
+        uint8_t g:2;
+        uint8_t r:2;
+        uint8_t a:2;
+    };
+} GColor8;
+typedef GColor8 GColor;
+
+#define GColorClear ((GColor8) { .argb = 0x00 })
+#define GColorBlack ((GColor8) { .argb = 0xc0 })
+#define GColorDarkGray ((GColor8) { .argb = 0xd5 })
+#define GColorLightGray ((GColor8) { .argb = 0xea })
+#define GColorWhite ((GColor8) { .argb = 0xff })
+#define GColorFromRGB(red, green, blue) ((GColor8) { .a = 3, .r = (red) >> 6, .g = (green) >> 6, .b = (blue) >> 6 })
+#define GColorFromHEX(v) GColorFromRGB(((v) >> 16) & 0xff, ((v) >> 8) & 0xff, (v) & 0xff)
+
+bool gcolor_equal(GColor8 x, GColor8 y);
+
+typedef struct GPoint {
+    int16_t x;
+    int16_t y;
+} GPoint;
+#define GPoint(x, y) ((GPoint) { (x), (y) })
+#define GPointZero GPoint(0, 0)
+
+typedef struct GSize {
+    int16_t w;
+    int16_t h;
+} GSize;
+#define GSize(w, h) ((GSize) { (w), (h) })
+#define GSizeZero GSize(0, 0)
+
+typedef struct GRect {
+    GPoint origin;
+    GSize size;
+} GRect;
+#define GRect(x, y, w, h) ((GRect) { { (x), (y) }, { (w), (h) } })
+#define GRectZero GRect(0, 0, 0, 0)
+
+bool gpoint_equal(const GPoint * const point_a, const GPoint * const point_b);
+bool gsize_equal(const GSize *size_a, const GSize *size_b);
+bool grect_equal(const GRect * const rect_a, const GRect * const rect_b);
+bool grect_is_empty(const GRect * const rect);
+void grect_clip(GRect * const rect_to_clip, const GRect * const rect_clipper);
+
+typedef enum {
+    GBitmapFormat1Bit = 0,
+    GBitmapFormat8Bit,
+    GBitmapFormat1BitPalette,
+    GBitmapFormat2BitPalette,
+    GBitmapFormat4BitPalette,
+    GBitmapFormat8BitCircular
+} GBitmapFormat;
+
+typedef struct GBitmap GBitmap;
+
+GBitmap *gbitmap_create_blank(GSize size, GBitmapFormat format);
+GBitmap *gbitmap_create_blank_with_palette(GSize size, GBitmapFormat format, GColor *palette, bool free_on_destroy);
+void gbitmap_destroy(GBitmap *bitmap);
+GRect gbitmap_get_bounds(const GBitmap *bitmap);
+void gbitmap_set_bounds(GBitmap *bitmap, GRect bounds);
+GBitmapFormat gbitmap_get_format(const GBitmap *bitmap);
+uint16_t gbitmap_get_bytes_per_row(const GBitmap *bitmap);
+uint8_t *gbitmap_get_data(const GBitmap *bitmap);
+void gbitmap_set_data(GBitmap *bitmap, uint8_t *data, GBitmapFormat format, uint16_t row_size_bytes, bool free_on_destroy);
+GColor *gbitmap_get_palette(const GBitmap *bitmap);
+
+typedef struct GContext GContext;
+
+typedef enum {
+    GCornerNone = 0
+} GCornerMask;
+
+typedef enum {
+    GCompOpAssign,
+    GCompOpAssignInverted,
+    GCompOpOr,
+    GCompOpAnd,
+    GCompOpClear,
+    GCompOpSet
+} GCompOp;
+
+typedef enum {
+    GTextAlignmentLeft,
+    GTextAlignmentCenter,
+    GTextAlignmentRight
+} GTextAlignment;
+
+void graphics_context_set_fill_color(GContext *ctx, GColor color);
+void graphics_context_set_compositing_mode(GContext *ctx, GCompOp mode);
+void graphics_fill_rect(GContext *ctx, GRect rect, uint16_t corner_radius, GCornerMask corner_mask);
+void graphics_draw_bitmap_in_rect(GContext *ctx, const GBitmap *bitmap, GRect rect);
+GBitmap *graphics_capture_frame_buffer(GContext *ctx);
+bool graphics_release_frame_buffer(GContext *ctx, GBitmap *buffer);
+
+// Layers and windows
+
+typedef struct Layer Layer;
+typedef void (*LayerUpdateProc)(struct Layer *layer, GContext *ctx);
+
+Layer *layer_create(GRect frame);
+Layer *layer_create_with_data(GRect frame, size_t data_size);
+void layer_destroy(Layer *layer);
+void *layer_get_data(const Layer *layer);
+void layer_set_update_proc(Layer *layer, LayerUpdateProc update_proc);
+void layer_mark_dirty(Layer *layer);
+void layer_add_child(Layer *parent, Layer *child);
+void layer_remove_from_parent(Layer *child);
+bool layer_get_hidden(const Layer *layer);
+void layer_set_hidden(Layer *layer, bool hidden);
+GRect layer_get_frame(const Layer *layer);
+void layer_set_frame(Layer *layer, GRect frame);
+GRect layer_get_bounds(const Layer *layer);
+void layer_set_bounds(Layer *layer, GRect bounds);
+void layer_set_clips(Layer *layer, bool clips);
+
+typedef struct Window Window;
+typedef void (*WindowHandler)(Window *window);
+typedef struct {
+    WindowHandler load;
+    WindowHandler appear;
+    WindowHandler disappear;
+    WindowHandler unload;
+} WindowHandlers;
+
+Window *window_create(void);
+void window_destroy(Window *window);
+void window_set_window_handlers(Window *window, WindowHandlers handlers);
+void window_set_background_color(Window *window, GColor background_color);
+Layer *window_get_root_layer(const Window *window);
+void window_stack_push(Window *window, bool animated);
+
+typedef struct FontInfo *GFont;
+#define FONT_KEY_GOTHIC_18_BOLD "RESOURCE_ID_GOTHIC_18_BOLD"
+#define FONT_KEY_GOTHIC_24_BOLD "RESOURCE_ID_GOTHIC_24_BOLD"
+#define FONT_KEY_BITHAM_30_BLACK "RESOURCE_ID_BITHAM_30_BLACK"
+#define FONT_KEY_ROBOTO_BOLD_SUBSET_49 "RESOURCE_ID_ROBOTO_BOLD_SUBSET_49"
+GFont fonts_get_system_font(const char *font_key);
+
+typedef struct TextLayer TextLayer;
+TextLayer *text_layer_create(GRect frame);
+void text_layer_destroy(TextLayer *text_layer);
+Layer *text_layer_get_layer(TextLayer *text_layer);
+void text_layer_set_text(TextLayer *text_layer, const char *text);
+const char *text_layer_get_text(TextLayer *text_layer);
+void text_layer_set_font(TextLayer *text_layer, GFont font);
+void text_layer_set_text_color(TextLayer *text_layer, GColor color);
+void text_layer_set_background_color(TextLayer *text_layer, GColor color);
+void text_layer_set_text_alignment(TextLayer *text_layer, GTextAlignment text_alignment);
+
+// Animations, stepped by the harness clock
+
+typedef struct Animation Animation;
+typedef int32_t AnimationProgress;
+#define ANIMATION_NORMALIZED_MIN 0
+#define ANIMATION_NORMALIZED_MAX 65535
+#define ANIMATION_DURATION_DEFAULT_MS 250
+
+typedef void (*AnimationSetupImplementation)(Animation *animation);
+typedef void (*AnimationUpdateImplementation)(Animation *animation, const AnimationProgress progress);
+typedef void (*AnimationTeardownImplementation)(Animation *animation);
+typedef struct {
+    AnimationSetupImplementation setup;
+    AnimationUpdateImplementation update;
+    AnimationTeardownImplementation teardown;
+} AnimationImplementation;
+
+typedef void (*AnimationStartedHandler)(Animation *animation, void *context);
+typedef void (*AnimationStoppedHandler)(Animation *animation, bool finished, void *context);
+typedef struct {
+    AnimationStartedHandler started;
+    AnimationStoppedHandler stopped;
+} AnimationHandlers;
+
+Animation *animation_create(void);
+bool animation_destroy(Animation *animation);
+Animation *animation_clone(Animation *from);
+bool animation_set_implementation(Animation *animation, const AnimationImplementation *implementation);
+bool animation_set_handlers(Animation *animation, AnimationHandlers callbacks, void *context);
+bool animation_set_reverse(Animation *animation, bool reverse);
+bool animation_set_delay(Animation *animation, uint32_t delay_ms);
+bool animation_set_duration(Animation *animation, uint32_t duration_ms);
+Animation *animation_sequence_create(Animation *animation_a, Animation *animation_b, Animation *animation_c, ...);
+bool animation_schedule(Animation *animation);
+bool animation_unschedule(Animation *animation);
+
+// Services
+
+typedef void (*TickHandler)(struct tm *tick_time, TimeUnits units_changed);
+
+typedef struct {
+    uint8_t charge_percent;
+    bool is_charging;
+    bool is_plugged;
+} BatteryChargeState;
+typedef void (*BatteryStateHandler)(BatteryChargeState charge);
+BatteryChargeState battery_state_service_peek(void);
+
+typedef void (*ConnectionHandler)(bool connected);
+typedef struct {
+    ConnectionHandler pebble_app_connection_handler;
+    ConnectionHandler pebblekit_connection_handler;
+} ConnectionHandlers;
+bool connection_service_peek_pebble_app_connection(void);
+
+typedef enum {
+    ACCEL_AXIS_X = 0,
+    ACCEL_AXIS_Y = 1,
+    ACCEL_AXIS_Z = 2
+} AccelAxisType;
+typedef void (*AccelTapHandler)(AccelAxisType axis, int32_t direction);
+
+typedef struct {
+    const uint32_t *durations;
+    uint32_t num_segments;
+} VibePattern;
+
+// the types are there on every platform, the service only where PBL_HEALTH is
+typedef int32_t HealthValue;
+
+typedef enum {
+    HealthMetricStepCount,
+    HealthMetricActiveSeconds,
+    HealthMetricWalkedDistanceMeters,
+    HealthMetricSleepSeconds,
+    HealthMetricSleepRestfulSeconds,
+    HealthMetricRestingKCalories,
+    HealthMetricActiveKCalories,
+    HealthMetricHeartRateBPM
+} HealthMetric;
+
+typedef enum {
+    HealthServiceAccessibilityMaskAvailable = 1 << 0,
+    HealthServiceAccessibilityMaskNoPermission = 1 << 1,
+    HealthServiceAccessibilityMaskNotSupported = 1 << 2,
+    HealthServiceAccessibilityMaskNotAvailable = 1 << 3
+} HealthServiceAccessibilityMask;
+
+typedef enum {
+    HealthEventSignificantUpdate = 0,
+    HealthEventMovementUpdate,
+    HealthEventSleepUpdate,
+    HealthEventMetricAlert,
+    HealthEventHeartRateUpdate
+} HealthEventType;
+
+typedef enum {
+    MeasurementSystemUnknown,
+    MeasurementSystemMetric,
+    MeasurementSystemImperial
+} MeasurementSystem;
+
+typedef void (*HealthEventHandler)(HealthEventType event, void *context);
+
+#ifdef PBL_HEALTH
+HealthServiceAccessibilityMask health_service_metric_accessible(HealthMetric metric, time_t time_start, time_t time_end);
+HealthValue health_service_sum_today(HealthMetric metric);
+HealthValue health_service_peek_current_value(HealthMetric metric);
+MeasurementSystem health_service_get_measurement_system_for_display(HealthMetric metric);
+#endif
+
+// App messages
+
+typedef enum {
+    TUPLE_BYTE_ARRAY = 0,
+    TUPLE_CSTRING = 1,
+    TUPLE_UINT = 2,
+    TUPLE_INT = 3
+} TupleType;
+
+typedef struct __attribute__((__packed__)) {
+    uint32_t key;
+    TupleType type:8;
+    uint16_t length;
+    union {
+        uint8_t data[0];
+        char cstring[0];
+        uint8_t uint8;
+        uint16_t uint16;
+        uint32_t uint32;
+        int8_t int8;
+        int16_t int16;
+        int32_t int32;
+    } value[];
+} Tuple;
+
+// tuples packed back to back, as the watch receives them
+typedef struct {
+    const uint8_t *begin;
+    const uint8_t *end;
+    Tuple *cursor;
+} DictionaryIterator;
+
+Tuple *dict_find(const DictionaryIterator *iter, const uint32_t key);
+
+typedef enum {
+    APP_MSG_OK = 0,
+    APP_MSG_SEND_TIMEOUT = 1 << 1,
+    APP_MSG_SEND_REJECTED = 1 << 2,
+    APP_MSG_NOT_CONNECTED = 1 << 3,
+    APP_MSG_BUSY = 1 << 6
+} AppMessageResult;
+
+typedef void (*AppMessageInboxReceived)(DictionaryIterator *iterator, void *context);
+typedef void (*AppMessageInboxDropped)(AppMessageResult reason, void *context);
+typedef void (*AppMessageOutboxSent)(DictionaryIterator *iterator, void *context);
+typedef void (*AppMessageOutboxFailed)(DictionaryIterator *iterator, AppMessageResult reason, void *context);
+
+// generated from package.json messageKeys on the watch
+enum {
+    MESSAGE_KEY_APP_READY = 10000,
+    MESSAGE_KEY_WEATHER_COMPACT,
+    MESSAGE_KEY_WEATHER_FORECAST,
+    MESSAGE_KEY_LEADING_ZERO,
+    MESSAGE_KEY_COLOR_BACKGROUND,
+    MESSAGE_KEY_COLOR_TEXT,
+    MESSAGE_KEY_COLOR_PINLINE,
+    MESSAGE_KEY_HOURLY_VIBE,
+    MESSAGE_KEY_CONNECTION_VIBE,
+    MESSAGE_KEY_WEATHER_UNIT,
+    MESSAGE_KEY_WEATHER_USE_GPS,
+    MESSAGE_KEY_WEATHER_LOCATION_NAME,
+    MESSAGE_KEY_WEATHER_INTERVAL,
+    MESSAGE_KEY_WIDGET_NW,
+    MESSAGE_KEY_WIDGET_NE,
+    MESSAGE_KEY_WIDGET_SW,
+    MESSAGE_KEY_WIDGET_SE,
+    MESSAGE_KEY_EXTRA_WIDGETS_ENABLED,
+    MESSAGE_KEY_EXTRA_WIDGET_NW,
+    MESSAGE_KEY_EXTRA_WIDGET_NE,
+    MESSAGE_KEY_EXTRA_WIDGET_SW,
+    MESSAGE_KEY_EXTRA_WIDGET_SE,
+    MESSAGE_KEY_HEALTH_INTERVAL
+};
+
+// Persistent storage, kept in memory for the life of the process
+
+#define PERSIST_DATA_MAX_LENGTH 256
+#define E_DOES_NOT_EXIST (-4)
+
+bool persist_exists(const uint32_t key);
+int32_t persist_read_int(const uint32_t key);
+int persist_read_data(const uint32_t key, void *buffer, const size_t buffer_size);
+int persist_write_int(const uint32_t key, const int32_t value);
+int persist_write_data(const uint32_t key, const void *data, const size_t size);
+int persist_delete(const uint32_t key);
+
+// Resources, read from resources/ at the top of the tree
+
+typedef void *ResHandle;
+
+// generated from package.json resources on the watch
+enum {
+    RESOURCE_ID_INVALID = 0,
+#ifndef PBL_PLATFORM_APLITE
+    RESOURCE_ID_TEXT_FFONT,
+#endif
+    RESOURCE_ID_WEATHER_CLEAR_DAY,
+    RESOURCE_ID_WEATHER_CLEAR_NIGHT,
+    RESOURCE_ID_WEATHER_PARTLY_CLOUDY_DAY,
+    RESOURCE_ID_WEATHER_PARTLY_CLOUDY_NIGHT,
+    RESOURCE_ID_WEATHER_CLOUDY,
+    RESOURCE_ID_WEATHER_RAIN,
+    RESOURCE_ID_WEATHER_THUNDER,
+    RESOURCE_ID_WEATHER_SNOW,
+    RESOURCE_ID_WEATHER_MIST,
+    RESOURCE_ID_WEATHER_NA
+};
+
+ResHandle resource_get_handle(uint32_t resource_id);
+size_t resource_size(ResHandle h);
+size_t resource_load(ResHandle h, uint8_t *buffer, size_t max_length);
@@ -0,0 +1,429 @@
+// The packages the face depends on, cut down to what the harness needs to drive
+// it: event subscriptions fired on demand, enamel settings held as strings,
+// and weather and geocode fetches that complete when the harness replies.
+#include <pebble.h>
+#include <enamel.h>
+#include <pebble-events/pebble-events.h>
+#include <pebble-connection-vibes/connection-vibes.h>
+#include <pebble-hourly-vibes/hourly-vibes.h>
+#include <pebble-generic-weather/pebble-generic-weather.h>
+#include <pebble-geocode-mapquest/pebble-geocode-mapquest.h>
+#include "host.h"
+
+#define HOST_SUBSCRIBERS 8
+
+// Subscribers, the handle being a pointer to the slot
+
+typedef struct {
+    void *handler;
+    void *context;
+    uint32_t flags;
+} HostSubscriber;
+
+static HostSubscriber s_tick[HOST_SUBSCRIBERS];
+static HostSubscriber s_battery[HOST_SUBSCRIBERS];
+static HostSubscriber s_connection[HOST_SUBSCRIBERS];
+static HostSubscriber s_tap[HOST_SUBSCRIBERS];
+static HostSubscriber s_health[HOST_SUBSCRIBERS];
+static HostSubscriber s_app_message[HOST_SUBSCRIBERS];
+static EventAppMessageHandlers s_app_message_handlers[HOST_SUBSCRIBERS];
+static HostSubscriber s_settings[HOST_SUBSCRIBERS];
+
+static EventHandle prv_subscribe(HostSubscriber *subscribers, void *handler, void *context, uint32_t flags) {
+    for (uint i = 0; i < HOST_SUBSCRIBERS; i++) {
+        if (subscribers[i].handler) continue;
+        subscribers[i] = (HostSubscriber) { handler, context, flags };
+        return &subscribers[i];
+    }
+    return NULL;
+}
+
+static void prv_unsubscribe(EventHandle handle) {
+    if (handle) memset(handle, 0, sizeof(HostSubscriber));
+}
+
+EventHandle events_tick_timer_service_subscribe(TimeUnits tick_units, TickHandler handler) {
+    return prv_subscribe(s_tick, handler, NULL, tick_units);
+}
+
+void events_tick_timer_service_unsubscribe(EventHandle handle) {
+    prv_unsubscribe(handle);
+}
+
+EventHandle events_battery_state_service_subscribe(BatteryStateHandler handler) {
+    return prv_subscribe(s_battery, handler, NULL, 0);
+}
+
+void events_battery_state_service_unsubscribe(EventHandle handle) {
+    prv_unsubscribe(handle);
+}
+
+static ConnectionHandlers s_connection_handlers[HOST_SUBSCRIBERS];
+
+EventHandle events_connection_service_subscribe(ConnectionHandlers conn_handlers) {
+    HostSubscriber *slot = prv_subscribe(s_connection, (void *) 1, NULL, 0);
+    if (slot) s_connection_handlers[slot - s_connection] = conn_handlers;
+    return slot;
+}
+
+void events_connection_service_unsubscribe(EventHandle handle) {
+    prv_unsubscribe(handle);
+}
+
+EventHandle events_accel_tap_service_subscribe(AccelTapHandler handler) {
+    return prv_subscribe(s_tap, handler, NULL, 0);
+}
+
+void events_accel_tap_service_unsubscribe(EventHandle handle) {
+    prv_unsubscribe(handle);
+}
+
+#ifdef PBL_HEALTH
+EventHandle events_health_service_events_subscribe(HealthEventHandler handler, void *context) {
+    return prv_subscribe(s_health, handler, context, 0);
+}
+
+void events_health_service_events_unsubscribe(EventHandle handle) {
+    prv_unsubscribe(handle);
+}
+#endif
+
+void events_app_message_open(void) {
+}
+
+EventHandle events_app_message_subscribe_handlers(EventAppMessageHandlers handlers, void *context) {
+    HostSubscriber *slot = prv_subscribe(s_app_message, (void *) 1, context, 0);
+    if (slot) s_app_message_handlers[slot - s_app_message] = handlers;
+    return slot;
+}
+
+void events_app_message_unsubscribe(EventHandle handle) {
+    prv_unsubscribe(handle);
+}
+
+// What the harness fires
+
+void host_fire_tick(struct tm *tick_time, TimeUnits units_changed) {
+    for (uint i = 0; i < HOST_SUBSCRIBERS; i++) {
+        if (s_tick[i].handler && (s_tick[i].flags & units_changed)) {
+            ((TickHandler) s_tick[i].handler)(tick_time, units_changed);
+        }
+    }
+}
+
+TimeUnits host_tick_units(void) {
+    TimeUnits units = 0;
+    for (uint i = 0; i < HOST_SUBSCRIBERS; i++) {
+        if (s_tick[i].handler) units |= s_tick[i].flags;
+    }
+    return units;
+}
+
+void host_fire_tap(void) {
+    for (uint i = 0; i < HOST_SUBSCRIBERS; i++) {
+        if (s_tap[i].handler) ((AccelTapHandler) s_tap[i].handler)(ACCEL_AXIS_Z, 1);
+    }
+}
+
+void host_fire_battery(void) {
+    for (uint i = 0; i < HOST_SUBSCRIBERS; i++) {
+        if (s_battery[i].handler) ((BatteryStateHandler) s_battery[i].handler)(battery_state_service_peek());
+    }
+}
+
+void host_fire_connection(void) {
+    bool connected = connection_service_peek_pebble_app_connection();
+    for (uint i = 0; i < HOST_SUBSCRIBERS; i++) {
+        if (!s_connection[i].handler) continue;
+        if (s_connection_handlers[i].pebble_app_connection_handler) {
+            s_connection_handlers[i].pebble_app_connection_handler(connected);
+        }
+    }
+}
+
+#ifdef PBL_HEALTH
+void host_fire_health(HealthEventType event) {
+    for (uint i = 0; i < HOST_SUBSCRIBERS; i++) {
+        if (s_health[i].handler) ((HealthEventHandler) s_health[i].handler)(event, s_health[i].context);
+    }
+}
+#endif
+
+void host_inbox(const uint8_t *dict, size_t length) {
+    DictionaryIterator iterator = { .begin = dict, .end = dict + length, .cursor = (Tuple *) dict };
+    for (uint i = 0; i < HOST_SUBSCRIBERS; i++) {
+        if (!s_app_message[i].handler || !s_app_message_handlers[i].received) continue;
+        s_app_message_handlers[i].received(&iterator, s_app_message[i].context);
+    }
+}
+
+// Vibes, nothing to feel on the host
+
+void connection_vibes_init(void) {
+}
+
+void connection_vibes_deinit(void) {
+}
+
+void connection_vibes_set_state(uint8_t state) {
+}
+
+void hourly_vibes_init(void) {
+}
+
+void hourly_vibes_deinit(void) {
+}
+
+void hourly_vibes_set_enabled(bool enabled) {
+}
+
+void hourly_vibes_set_pattern(VibePattern pattern) {
+}
+
+#ifdef PBL_HEALTH
+void connection_vibes_enable_health(bool enable) {
+}
+
+void hourly_vibes_enable_health(bool enable) {
+}
+#endif
+
+// Enamel, starting at the src/pkjs/config.json defaults
+
+typedef struct {
+    const char *key;
+    char value[32];
+} HostSetting;
+
+static HostSetting s_settings_values[] = {
+    { "LEADING_ZERO", "false" },
+    { "COLOR_BACKGROUND", "000000" },
+    { "COLOR_TEXT", "FFFFFF" },
+    { "COLOR_PINLINE", "555555" },
+    { "HOURLY_VIBE", "true" },
+    { "CONNECTION_VIBE", "1" },
+    { "WIDGET_NW", "1" },
+    { "WIDGET_NE", "2" },
+    { "WIDGET_SW", "3" },
+    { "WIDGET_SE", "4" },
+    { "EXTRA_WIDGETS_ENABLED", "false" },
+    { "EXTRA_WIDGET_NW", "0" },
+    { "EXTRA_WIDGET_NE", "0" },
+    { "EXTRA_WIDGET_SW", "0" },
+    { "EXTRA_WIDGET_SE", "0" },
+    { "HEALTH_INTERVAL", "60" },
+    { "WEATHER_UNIT", "0" },
+    { "WEATHER_USE_GPS", "true" },
+    { "WEATHER_LOCATION_NAME", "" },
+    { "WEATHER_INTERVAL", "60" },
+};
+
+static const char *prv_setting(const char *key) {
+    for (uint i = 0; i < ARRAY_LENGTH(s_settings_values); i++) {
+        if (strcmp(s_settings_values[i].key, key) == 0) return s_settings_values[i].value;
+    }
+    fprintf(stderr, "unknown setting %s\n", key);
+    abort();
+}
+
+static bool prv_setting_bool(const char *key) {
+    return strcmp(prv_setting(key), "true") == 0;
+}
+
+static GColor prv_setting_color(const char *key) {
+    return GColorFromHEX(strtoul(prv_setting(key), NULL, 16));
+}
+
+void host_settings_set(const char *key, const char *value) {
+    for (uint i = 0; i < ARRAY_LENGTH(s_settings_values); i++) {
+        if (strcmp(s_settings_values[i].key, key) != 0) continue;
+        snprintf(s_settings_values[i].value, sizeof(s_settings_values[i].value), "%s", value);
+        return;
+    }
+    fprintf(stderr, "unknown setting %s\n", key);
+    abort();
+}
+
+// As if the settings page had been saved
+void host_settings_apply(void) {
+    for (uint i = 0; i < HOST_SUBSCRIBERS; i++) {
+        if (s_settings[i].handler) ((EnamelSettingsReceivedHandler) s_settings[i].handler)(s_settings[i].context);
+    }
+}
+
+void enamel_init(void) {
+}
+
+void enamel_deinit(void) {
+}
+
+EventHandle enamel_settings_received_subscribe(EnamelSettingsReceivedHandler handler, void *context) {
+    return prv_subscribe(s_settings, handler, context, 0);
+}
+
+void enamel_settings_received_unsubscribe(EventHandle handle) {
+    prv_unsubscribe(handle);
+}
+
+bool enamel_get_LEADING_ZERO(void) { return prv_setting_bool("LEADING_ZERO"); }
+GColor enamel_get_COLOR_BACKGROUND(void) { return prv_setting_color("COLOR_BACKGROUND"); }
+GColor enamel_get_COLOR_TEXT(void) { return prv_setting_color("COLOR_TEXT"); }
+GColor enamel_get_COLOR_PINLINE(void) { return prv_setting_color("COLOR_PINLINE"); }
+bool enamel_get_HOURLY_VIBE(void) { return prv_setting_bool("HOURLY_VIBE"); }
+const char *enamel_get_CONNECTION_VIBE(void) { return prv_setting("CONNECTION_VIBE"); }
+const char *enamel_get_WIDGET_NW(void) { return prv_setting("WIDGET_NW"); }
+const char *enamel_get_WIDGET_NE(void) { return prv_setting("WIDGET_NE"); }
+const char *enamel_get_WIDGET_SW(void) { return prv_setting("WIDGET_SW"); }
+const char *enamel_get_WIDGET_SE(void) { return prv_setting("WIDGET_SE"); }
+bool enamel_get_EXTRA_WIDGETS_ENABLED(void) { return prv_setting_bool("EXTRA_WIDGETS_ENABLED"); }
+const char *enamel_get_EXTRA_WIDGET_NW(void) { return prv_setting("EXTRA_WIDGET_NW"); }
+const char *enamel_get_EXTRA_WIDGET_NE(void) { return prv_setting("EXTRA_WIDGET_NE"); }
+const char *enamel_get_EXTRA_WIDGET_SW(void) { return prv_setting("EXTRA_WIDGET_SW"); }
+const char *enamel_get_EXTRA_WIDGET_SE(void) { return prv_setting("EXTRA_WIDGET_SE"); }
+const char *enamel_get_HEALTH_INTERVAL(void) { return prv_setting("HEALTH_INTERVAL"); }
+const char *enamel_get_WEATHER_UNIT(void) { return prv_setting("WEATHER_UNIT"); }
+bool enamel_get_WEATHER_USE_GPS(void) { return prv_setting_bool("WEATHER_USE_GPS"); }
+const char *enamel_get_WEATHER_LOCATION_NAME(void) { return prv_setting("WEATHER_LOCATION_NAME"); }
+const char *enamel_get_WEATHER_INTERVAL(void) { return prv_setting("WEATHER_INTERVAL"); }
+
+// Generic weather
+
+static GenericWeatherInfo s_weather_info;
+static GenericWeatherCallback s_weather_callback;
+static uint32_t s_weather_fetches;
+static GenericWeatherProvider s_weather_provider;
+static char s_weather_api_key[64];
+static GenericWeatherCoordinates s_weather_location;
+
+void generic_weather_init(void) {
+    memset(&s_weather_info, 0, sizeof(s_weather_info));
+    s_weather_info.condition = GenericWeatherConditionUnknown;
+}
+
+void generic_weather_deinit(void) {
+    s_weather_callback = NULL;
+}
+
+void generic_weather_set_api_key(const char *api_key) {
+    snprintf(s_weather_api_key, sizeof(s_weather_api_key), "%s", api_key ? api_key : "");
+}
+
+void generic_weather_set_provider(GenericWeatherProvider provider) {
+    s_weather_provider = provider;
+}
+
+void generic_weather_set_location(const GenericWeatherCoordinates coordinates) {
+    s_weather_location = coordinates;
+}
+
+bool generic_weather_fetch(GenericWeatherCallback callback) {
+    if (!connection_service_peek_pebble_app_connection()) {
+        callback(&s_weather_info, GenericWeatherStatusBluetoothDisconnected);
+        return false;
+    }
+    s_weather_callback = callback;
+    s_weather_fetches++;
+    callback(&s_weather_info, GenericWeatherStatusPending);
+    return true;
+}
+
+GenericWeatherInfo *generic_weather_peek(void) {
+    return &s_weather_info;
+}
+
+void generic_weather_save(const uint32_t key) {
+    persist_write_data(key, &s_weather_info, sizeof(s_weather_info));
+}
+
+void generic_weather_load(const uint32_t key) {
+    if (persist_exists(key)) persist_read_data(key, &s_weather_info, sizeof(s_weather_info));
+}
+
+uint32_t host_weather_fetch_count(void) {
+    return s_weather_fetches;
+}
+
+// Plausible weather as of timestamp, for the harness to send
+GenericWeatherInfo host_sample_weather(time_t timestamp) {
+    time_t midnight = timestamp - timestamp % SECONDS_PER_DAY;
+    return (GenericWeatherInfo) {
+        .temp_k = 290,
+        .temp_c = 17,
+        .temp_f = 63,
+        .temp_feels_like_c = 16,
+        .temp_feels_like_f = 61,
+        .temp_low_c = 11,
+        .temp_low_f = 52,
+        .temp_high_c = 21,
+        .temp_high_f = 70,
+        .humidity = 64,
+        .name = "Host",
+        .description = "few clouds",
+        .condition = GenericWeatherConditionFewClouds,
+        .timestamp = timestamp,
+        .day = true,
+        .timesunrise = midnight + 7 * SECONDS_PER_HOUR,
+        .timesunset = midnight + 19 * SECONDS_PER_HOUR,
+    };
+}
+
+// Completes the fetch in flight, as the library's own reply would
+void host_weather_reply(const GenericWeatherInfo *info, GenericWeatherStatus status) {
+    GenericWeatherCallback callback = s_weather_callback;
+    s_weather_callback = NULL;
+    if (!callback) return;
+    if (info) s_weather_info = *info;
+    callback(&s_weather_info, status);
+}
+
+// Geocode
+
+static GeocodeMapquestCoordinates s_geocode_coordinates;
+static GeocodeMapquestCallback s_geocode_callback;
+static uint32_t s_geocode_fetches;
+
+void geocode_mapquest_init(void) {
+    memset(&s_geocode_coordinates, 0, sizeof(s_geocode_coordinates));
+}
+
+void geocode_mapquest_deinit(void) {
+    s_geocode_callback = NULL;
+}
+
+void geocode_mapquest_set_api_key(const char *api_key) {
+}
+
+bool geocode_mapquest_fetch(const char *location, GeocodeMapquestCallback callback) {
+    s_geocode_callback = callback;
+    s_geocode_fetches++;
+    callback(&s_geocode_coordinates, GeocodeMapquestStatusPending);
+    return true;
+}
+
+GeocodeMapquestCoordinates *geocode_mapquest_peek(void) {
+    return &s_geocode_coordinates;
+}
+
+void geocode_mapquest_save(const uint32_t key) {
+    persist_write_data(key, &s_geocode_coordinates, sizeof(s_geocode_coordinates));
+}
+
+void geocode_mapquest_load(const uint32_t key) {
+    if (persist_exists(key)) persist_read_data(key, &s_geocode_coordinates, sizeof(s_geocode_coordinates));
+}
+
+GenericWeatherCoordinates host_weather_location(void) {
+    return s_weather_location;
+}
+
+uint32_t host_geocode_fetch_count(void) {
+    return s_geocode_fetches;
+}
+
+void host_geocode_reply(const GeocodeMapquestCoordinates *coordinates, GeocodeMapquestStatus status) {
+    GeocodeMapquestCallback callback = s_geocode_callback;
+    s_geocode_callback = NULL;
+    if (!callback) return;
+    if (coordinates) s_geocode_coordinates = *coordinates;
+    callback(&s_geocode_coordinates, status);
+}
@@ -0,0 +1,1185 @@
+// The part of the Pebble SDK the face uses, on Linux: a counted heap, a virtual
+// clock with timers, a layer tree rendered into an in-memory frame buffer,
+// bitmaps, animations and in-memory persistent storage.
+#include <pebble.h>
+#include <stdarg.h>
+#include <time.h>
+#include "host.h"
+
+#undef malloc
+#undef calloc
+#undef realloc
+#undef free
+#undef time
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Total app heap, code excluded, roughly what each platform leaves a face
+#ifdef PBL_PLATFORM_APLITE
+#define HOST_HEAP_SIZE (24 * 1024)
+#else
+#define HOST_HEAP_SIZE (64 * 1024)
+#endif
+
+#define HOST_FRAME_BUFFER_ROW_SIZE PBL_IF_COLOR_ELSE(PBL_DISPLAY_WIDTH, 20)
+
+// Heap
+
+typedef struct {
+    size_t size;
+    size_t pad;
+} HostBlock;
+
+static HostHeapStats s_heap;
+
+void *host_malloc(size_t size) {
+    if (s_heap.used + size + sizeof(HostBlock) > HOST_HEAP_SIZE) return NULL;
+    HostBlock *block = malloc(sizeof(HostBlock) + size);
+    if (!block) return NULL;
+    block->size = size;
+    s_heap.used += size;
+    if (s_heap.used > s_heap.peak) s_heap.peak = s_heap.used;
+    if (s_heap.used > s_heap.high_water) s_heap.high_water = s_heap.used;
+    s_heap.allocs++;
+    return block + 1;
+}
+
+void *host_calloc(size_t count, size_t size) {
+    void *ptr = host_malloc(count * size);
+    if (ptr) memset(ptr, 0, count * size);
+    return ptr;
+}
+
+void host_free(void *ptr) {
+    if (!ptr) return;
+    HostBlock *block = (HostBlock *) ptr - 1;
+    s_heap.used -= block->size;
+    s_heap.frees++;
+    free(block);
+}
+
+void *host_realloc(void *ptr, size_t size) {
+    if (!ptr) return host_malloc(size);
+    HostBlock *block = (HostBlock *) ptr - 1;
+    void *copy = host_malloc(size);
+    if (!copy) return NULL;
+    memcpy(copy, ptr, block->size < size ? block->size : size);
+    host_free(ptr);
+    return copy;
+}
+
+size_t heap_bytes_used(void) {
+    return s_heap.used;
+}
+
+size_t heap_bytes_free(void) {
+    return HOST_HEAP_SIZE - s_heap.used;
+}
+
+HostHeapStats host_heap_stats(void) {
+    return s_heap;
+}
+
+void host_heap_reset_peak(void) {
+    s_heap.peak = s_heap.used;
+}
+
+// Logging, the watch's 32 bit longs are printed as ints
+
+static uint8_t s_log_level = APP_LOG_LEVEL_INFO;
+static uint32_t s_log_counts[256];
+
+void app_log(uint8_t log_level, const char *src_filename, int src_line_number, const char *fmt, ...) {
+    s_log_counts[log_level]++;
+    if (log_level > s_log_level) return;
+
+    char host_fmt[256];
+    size_t n = 0;
+    for (const char *c = fmt; *c && n < sizeof(host_fmt) - 1; c++) {
+        host_fmt[n++] = *c;
+        if (*c != '%') continue;
+        while (c[1] && strchr("-+ #0123456789.", c[1]) && n < sizeof(host_fmt) - 1) host_fmt[n++] = *++c;
+        if (c[1] == 'l') c++;
+    }
+    host_fmt[n] = '\0';
+
+    const char *file = strrchr(src_filename, '/');
+    fprintf(stderr, "%s:%d> ", file ? file + 1 : src_filename, src_line_number);
+    va_list args;
+    va_start(args, fmt);
+    vfprintf(stderr, host_fmt, args);
+    va_end(args);
+    fputc('\n', stderr);
+}
+
+uint32_t host_log_count(uint8_t level) {
+    return s_log_counts[level];
+}
+
+void host_log_set_level(uint8_t level) {
+    s_log_level = level;
+}
+
+// Clock, real time plus whatever the harness skipped ahead
+
+static struct timespec s_real_start;
+// Sat 2026-10-17 08:59:30 UTC
+static uint64_t s_epoch_ms = 1792227570000ULL;
+static uint64_t s_skipped_ms;
+
+uint64_t host_now_ms(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    uint64_t elapsed = (now.tv_sec - s_real_start.tv_sec) * 1000 + (now.tv_nsec - s_real_start.tv_nsec) / 1000000;
+    return s_epoch_ms + s_skipped_ms + elapsed;
+}
+
+void host_skip_ms(uint64_t ms) {
+    s_skipped_ms += ms;
+}
+
+uint64_t host_cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000ULL + now.tv_nsec;
+#endif
+}
+
+time_t host_time(time_t *tloc) {
+    time_t now = host_now_ms() / 1000;
+    if (tloc) *tloc = now;
+    return now;
+}
+
+uint16_t time_ms(time_t *t_utc, uint16_t *out_ms) {
+    uint64_t now = host_now_ms();
+    if (t_utc) *t_utc = now / 1000;
+    if (out_ms) *out_ms = now % 1000;
+    return now % 1000;
+}
+
+time_t time_start_of_today(void) {
+    time_t now = host_time(NULL);
+    struct tm *local = localtime(&now);
+    return now - (local->tm_hour * SECONDS_PER_HOUR + local->tm_min * SECONDS_PER_MINUTE + local->tm_sec);
+}
+
+bool clock_is_24h_style(void) {
+    return true;
+}
+
+// Timers, kept by the system on the watch and so not on the app heap
+
+struct AppTimer {
+    uint64_t due_ms;
+    AppTimerCallback callback;
+    void *data;
+    AppTimer *next;
+};
+
+static AppTimer *s_timers;
+
+AppTimer *app_timer_register(uint32_t timeout_ms, AppTimerCallback callback, void *callback_data) {
+    AppTimer *timer = malloc(sizeof(AppTimer));
+    timer->due_ms = host_now_ms() + timeout_ms;
+    timer->callback = callback;
+    timer->data = callback_data;
+    timer->next = s_timers;
+    s_timers = timer;
+    return timer;
+}
+
+static bool prv_timer_unlink(AppTimer *timer) {
+    for (AppTimer **link = &s_timers; *link; link = &(*link)->next) {
+        if (*link != timer) continue;
+        *link = timer->next;
+        return true;
+    }
+    return false;
+}
+
+bool app_timer_reschedule(AppTimer *timer, uint32_t new_timeout_ms) {
+    for (AppTimer *t = s_timers; t; t = t->next) {
+        if (t != timer) continue;
+        t->due_ms = host_now_ms() + new_timeout_ms;
+        return true;
+    }
+    return false;
+}
+
+void app_timer_cancel(AppTimer *timer) {
+    if (prv_timer_unlink(timer)) free(timer);
+}
+
+static AppTimer *prv_next_timer(void) {
+    AppTimer *next = NULL;
+    for (AppTimer *t = s_timers; t; t = t->next) {
+        if (!next || t->due_ms < next->due_ms) next = t;
+    }
+    return next;
+}
+
+bool host_next_timer_due(uint64_t *due_ms) {
+    AppTimer *next = prv_next_timer();
+    if (next) *due_ms = next->due_ms;
+    return next != NULL;
+}
+
+// Skips the clock to the earliest timer due by until_ms and fires it
+bool host_fire_next_timer(uint64_t until_ms) {
+    AppTimer *next = prv_next_timer();
+    if (!next || next->due_ms > until_ms) return false;
+    uint64_t now = host_now_ms();
+    if (next->due_ms > now) host_skip_ms(next->due_ms - now);
+    prv_timer_unlink(next);
+    AppTimerCallback callback = next->callback;
+    void *data = next->data;
+    free(next);
+    callback(data);
+    return true;
+}
+
+// Geometry
+
+bool gcolor_equal(GColor8 x, GColor8 y) {
+    return x.argb == y.argb || (x.a == 0 && y.a == 0);
+}
+
+bool gpoint_equal(const GPoint * const point_a, const GPoint * const point_b) {
+    return point_a->x == point_b->x && point_a->y == point_b->y;
+}
+
+bool gsize_equal(const GSize *size_a, const GSize *size_b) {
+    return size_a->w == size_b->w && size_a->h == size_b->h;
+}
+
+bool grect_equal(const GRect * const rect_a, const GRect * const rect_b) {
+    return gpoint_equal(&rect_a->origin, &rect_b->origin) && gsize_equal(&rect_a->size, &rect_b->size);
+}
+
+bool grect_is_empty(const GRect * const rect) {
+    return rect->size.w == 0 && rect->size.h == 0;
+}
+
+void grect_clip(GRect * const rect_to_clip, const GRect * const rect_clipper) {
+    int16_t x1 = rect_to_clip->origin.x > rect_clipper->origin.x ? rect_to_clip->origin.x : rect_clipper->origin.x;
+    int16_t y1 = rect_to_clip->origin.y > rect_clipper->origin.y ? rect_to_clip->origin.y : rect_clipper->origin.y;
+    int16_t x2 = rect_to_clip->origin.x + rect_to_clip->size.w;
+    int16_t y2 = rect_to_clip->origin.y + rect_to_clip->size.h;
+    if (x2 > rect_clipper->origin.x + rect_clipper->size.w) x2 = rect_clipper->origin.x + rect_clipper->size.w;
+    if (y2 > rect_clipper->origin.y + rect_clipper->size.h) y2 = rect_clipper->origin.y + rect_clipper->size.h;
+    *rect_to_clip = (x2 > x1 && y2 > y1) ? GRect(x1, y1, x2 - x1, y2 - y1) : GRect(x1, y1, 0, 0);
+}
+
+// Bitmaps
+
+struct GBitmap {
+    GBitmapFormat format;
+    uint16_t row_size;
+    GRect bounds;
+    uint8_t *data;
+    bool free_data;
+    GColor *palette;
+    bool free_palette;
+};
+
+static uint16_t prv_row_size(GBitmapFormat format, int16_t w) {
+    switch (format) {
+        case GBitmapFormat1Bit: return (w + 31) / 32 * 4;
+        case GBitmapFormat1BitPalette: return (w + 7) / 8;
+        case GBitmapFormat2BitPalette: return (w + 3) / 4;
+        case GBitmapFormat4BitPalette: return (w + 1) / 2;
+        default: return w;
+    }
+}
+
+GBitmap *gbitmap_create_blank(GSize size, GBitmapFormat format) {
+    GBitmap *bitmap = host_malloc(sizeof(GBitmap));
+    if (!bitmap) return NULL;
+    bitmap->format = format;
+    bitmap->row_size = prv_row_size(format, size.w);
+    bitmap->bounds = GRect(0, 0, size.w, size.h);
+    bitmap->data = host_calloc(bitmap->row_size, size.h);
+    bitmap->free_data = true;
+    bitmap->palette = NULL;
+    bitmap->free_palette = false;
+    if (!bitmap->data) {
+        host_free(bitmap);
+        return NULL;
+    }
+    return bitmap;
+}
+
+GBitmap *gbitmap_create_blank_with_palette(GSize size, GBitmapFormat format, GColor *palette, bool free_on_destroy) {
+    GBitmap *bitmap = gbitmap_create_blank(size, format);
+    if (!bitmap) return NULL;
+    bitmap->palette = palette;
+    bitmap->free_palette = free_on_destroy;
+    return bitmap;
+}
+
+void gbitmap_destroy(GBitmap *bitmap) {
+    if (!bitmap) return;
+    if (bitmap->free_data) host_free(bitmap->data);
+    if (bitmap->free_palette) host_free(bitmap->palette);
+    host_free(bitmap);
+}
+
+GRect gbitmap_get_bounds(const GBitmap *bitmap) {
+    return bitmap->bounds;
+}
+
+void gbitmap_set_bounds(GBitmap *bitmap, GRect bounds) {
+    bitmap->bounds = bounds;
+}
+
+GBitmapFormat gbitmap_get_format(const GBitmap *bitmap) {
+    return bitmap->format;
+}
+
+uint16_t gbitmap_get_bytes_per_row(const GBitmap *bitmap) {
+    return bitmap->row_size;
+}
+
+uint8_t *gbitmap_get_data(const GBitmap *bitmap) {
+    return bitmap->data;
+}
+
+void gbitmap_set_data(GBitmap *bitmap, uint8_t *data, GBitmapFormat format, uint16_t row_size_bytes, bool free_on_destroy) {
+    if (bitmap->free_data && bitmap->data != data) host_free(bitmap->data);
+    bitmap->data = data;
+    bitmap->format = format;
+    bitmap->row_size = row_size_bytes;
+    bitmap->free_data = free_on_destroy;
+}
+
+GColor *gbitmap_get_palette(const GBitmap *bitmap) {
+    return bitmap->palette;
+}
+
+static GColor prv_bitmap_get(const GBitmap *bitmap, int16_t x, int16_t y) {
+    const uint8_t *row = bitmap->data + y * bitmap->row_size;
+    switch (bitmap->format) {
+        case GBitmapFormat1Bit:
+            return ((row[x / 8] >> (x % 8)) & 1) ? GColorWhite : GColorBlack;
+        case GBitmapFormat1BitPalette:
+            return bitmap->palette[(row[x / 8] >> (7 - x % 8)) & 0x1];
+        case GBitmapFormat2BitPalette:
+            return bitmap->palette[(row[x / 4] >> ((3 - x % 4) * 2)) & 0x3];
+        case GBitmapFormat4BitPalette:
+            return bitmap->palette[(row[x / 2] >> ((1 - x % 2) * 4)) & 0xf];
+        default:
+            return (GColor) { .argb = row[x] };
+    }
+}
+
+static bool prv_is_white(GColor color) {
+    return color.r + color.g + color.b >= 5;
+}
+
+static void prv_bitmap_set(GBitmap *bitmap, int16_t x, int16_t y, GColor color) {
+    uint8_t *row = bitmap->data + y * bitmap->row_size;
+    if (bitmap->format == GBitmapFormat1Bit) {
+        if (prv_is_white(color)) row[x / 8] |= 1 << (x % 8);
+        else row[x / 8] &= ~(1 << (x % 8));
+    } else {
+        row[x] = color.argb | 0xc0;
+    }
+}
+
+static GColor prv_blend(GColor dst, GColor src, uint8_t alpha) {
+    GColor color = GColorBlack;
+    color.r = (dst.r * (3 - alpha) + src.r * alpha + 1) / 3;
+    color.g = (dst.g * (3 - alpha) + src.g * alpha + 1) / 3;
+    color.b = (dst.b * (3 - alpha) + src.b * alpha + 1) / 3;
+    return color;
+}
+
+// Graphics contexts
+
+struct GContext {
+    GBitmap *target;
+    GPoint origin;
+    GRect clip;
+    GColor fill_color;
+    GCompOp compositing;
+    bool captured;
+};
+
+static uint8_t s_frame_buffer_data[HOST_FRAME_BUFFER_ROW_SIZE * PBL_DISPLAY_HEIGHT];
+static GBitmap s_frame_buffer = {
+    .format = PBL_IF_COLOR_ELSE(GBitmapFormat8Bit, GBitmapFormat1Bit),
+    .row_size = HOST_FRAME_BUFFER_ROW_SIZE,
+    .bounds = { { 0, 0 }, { PBL_DISPLAY_WIDTH, PBL_DISPLAY_HEIGHT } },
+    .data = s_frame_buffer_data,
+};
+static GContext s_context = { .target = &s_frame_buffer };
+static HostFrameStats s_frame_stats;
+
+GBitmap *host_frame_buffer(void) {
+    return &s_frame_buffer;
+}
+
+GContext *host_graphics_context(void) {
+    return &s_context;
+}
+
+void host_count_fill(uint32_t pixels) {
+    s_frame_stats.fills++;
+    s_frame_stats.pixels += pixels;
+}
+
+// Only writes that land in the screen's own pixels count, not redirected ones
+void host_touch(GRect rect) {
+    if (s_frame_buffer.data != s_frame_buffer_data || rect.size.w <= 0 || rect.size.h <= 0) return;
+    GRect *touched = &s_frame_stats.touched;
+    if (touched->size.w == 0) {
+        *touched = rect;
+        return;
+    }
+    int16_t x1 = touched->origin.x < rect.origin.x ? touched->origin.x : rect.origin.x;
+    int16_t y1 = touched->origin.y < rect.origin.y ? touched->origin.y : rect.origin.y;
+    int16_t x2 = touched->origin.x + touched->size.w;
+    int16_t y2 = touched->origin.y + touched->size.h;
+    if (rect.origin.x + rect.size.w > x2) x2 = rect.origin.x + rect.size.w;
+    if (rect.origin.y + rect.size.h > y2) y2 = rect.origin.y + rect.size.h;
+    *touched = GRect(x1, y1, x2 - x1, y2 - y1);
+}
+
+void host_touch_pixel(int16_t x, int16_t y) {
+    host_touch(GRect(x, y, 1, 1));
+}
+
+void graphics_context_set_fill_color(GContext *ctx, GColor color) {
+    ctx->fill_color = color;
+}
+
+void graphics_context_set_compositing_mode(GContext *ctx, GCompOp mode) {
+    ctx->compositing = mode;
+}
+
+static GRect prv_draw_rect(GContext *ctx, GRect rect) {
+    rect.origin.x += ctx->origin.x;
+    rect.origin.y += ctx->origin.y;
+    grect_clip(&rect, &ctx->clip);
+    GRect bounds = ctx->target->bounds;
+    grect_clip(&rect, &bounds);
+    return rect;
+}
+
+void graphics_fill_rect(GContext *ctx, GRect rect, uint16_t corner_radius, GCornerMask corner_mask) {
+    if (ctx->fill_color.a == 0) return;
+    rect = prv_draw_rect(ctx, rect);
+    for (int16_t y = rect.origin.y; y < rect.origin.y + rect.size.h; y++) {
+        for (int16_t x = rect.origin.x; x < rect.origin.x + rect.size.w; x++) prv_bitmap_set(ctx->target, x, y, ctx->fill_color);
+    }
+    s_frame_stats.pixels += rect.size.w * rect.size.h;
+    host_touch(rect);
+}
+
+// Tiles the bitmap's bounds over rect, like the watch does
+void graphics_draw_bitmap_in_rect(GContext *ctx, const GBitmap *bitmap, GRect rect) {
+    if (!bitmap || bitmap->bounds.size.w <= 0 || bitmap->bounds.size.h <= 0) return;
+    GRect dst = prv_draw_rect(ctx, rect);
+    int16_t origin_x = rect.origin.x + ctx->origin.x;
+    int16_t origin_y = rect.origin.y + ctx->origin.y;
+    GRect src = bitmap->bounds;
+    bool same_1bit = bitmap->format == GBitmapFormat1Bit && ctx->target->format == GBitmapFormat1Bit;
+    for (int16_t y = dst.origin.y; y < dst.origin.y + dst.size.h; y++) {
+        int16_t sy = src.origin.y + (y - origin_y) % src.size.h;
+        for (int16_t x = dst.origin.x; x < dst.origin.x + dst.size.w; x++) {
+            int16_t sx = src.origin.x + (x - origin_x) % src.size.w;
+            GColor color = prv_bitmap_get(bitmap, sx, sy);
+            if (ctx->compositing == GCompOpSet && !same_1bit) {
+                if (color.a == 0) continue;
+                if (color.a < 3) color = prv_blend(prv_bitmap_get(ctx->target, x, y), color, color.a);
+            }
+            prv_bitmap_set(ctx->target, x, y, color);
+        }
+    }
+    s_frame_stats.blits++;
+    s_frame_stats.pixels += dst.size.w * dst.size.h;
+    host_touch(dst);
+}
+
+GBitmap *graphics_capture_frame_buffer(GContext *ctx) {
+    if (ctx->captured) return NULL;
+    ctx->captured = true;
+    return ctx->target;
+}
+
+bool graphics_release_frame_buffer(GContext *ctx, GBitmap *buffer) {
+    ctx->captured = false;
+    return buffer == ctx->target;
+}
+
+// Layers
+
+struct Layer {
+    GRect frame;
+    GRect bounds;
+    LayerUpdateProc update_proc;
+    Layer *parent;
+    Layer *first_child;
+    Layer *next_sibling;
+    bool hidden;
+    bool clips;
+    void *data;
+};
+
+static bool s_needs_render;
+
+Layer *layer_create(GRect frame) {
+    return layer_create_with_data(frame, 0);
+}
+
+Layer *layer_create_with_data(GRect frame, size_t data_size) {
+    Layer *layer = host_calloc(1, sizeof(Layer) + data_size);
+    if (!layer) return NULL;
+    layer->frame = frame;
+    layer->bounds = GRect(0, 0, frame.size.w, frame.size.h);
+    layer->clips = true;
+    layer->data = data_size ? layer + 1 : NULL;
+    return layer;
+}
+
+void layer_destroy(Layer *layer) {
+    if (!layer) return;
+    layer_remove_from_parent(layer);
+    for (Layer *child = layer->first_child; child; child = child->next_sibling) child->parent = NULL;
+    host_free(layer);
+}
+
+void *layer_get_data(const Layer *layer) {
+    return layer->data;
+}
+
+void layer_set_update_proc(Layer *layer, LayerUpdateProc update_proc) {
+    layer->update_proc = update_proc;
+}
+
+void layer_mark_dirty(Layer *layer) {
+    s_needs_render = true;
+}
+
+void layer_add_child(Layer *parent, Layer *child) {
+    layer_remove_from_parent(child);
+    child->parent = parent;
+    Layer **link = &parent->first_child;
+    while (*link) link = &(*link)->next_sibling;
+    *link = child;
+    s_needs_render = true;
+}
+
+void layer_remove_from_parent(Layer *child) {
+    if (!child->parent) return;
+    for (Layer **link = &child->parent->first_child; *link; link = &(*link)->next_sibling) {
+        if (*link != child) continue;
+        *link = child->next_sibling;
+        break;
+    }
+    child->parent = NULL;
+    child->next_sibling = NULL;
+    s_needs_render = true;
+}
+
+bool layer_get_hidden(const Layer *layer) {
+    return layer->hidden;
+}
+
+void layer_set_hidden(Layer *layer, bool hidden) {
+    if (layer->hidden == hidden) return;
+    layer->hidden = hidden;
+    s_needs_render = true;
+}
+
+GRect layer_get_frame(const Layer *layer) {
+    return layer->frame;
+}
+
+void layer_set_frame(Layer *layer, GRect frame) {
+    layer->frame = frame;
+    layer->bounds.size = frame.size;
+    s_needs_render = true;
+}
+
+GRect layer_get_bounds(const Layer *layer) {
+    return layer->bounds;
+}
+
+void layer_set_bounds(Layer *layer, GRect bounds) {
+    layer->bounds = bounds;
+    s_needs_render = true;
+}
+
+void layer_set_clips(Layer *layer, bool clips) {
+    layer->clips = clips;
+}
+
+// Windows, only ever one on the stack
+
+struct Window {
+    Layer *root_layer;
+    WindowHandlers handlers;
+    GColor background;
+    bool loaded;
+};
+
+static Window *s_window;
+
+Window *window_create(void) {
+    Window *window = host_calloc(1, sizeof(Window));
+    window->root_layer = layer_create(GRect(0, 0, PBL_DISPLAY_WIDTH, PBL_DISPLAY_HEIGHT));
+    window->background = GColorWhite;
+    return window;
+}
+
+void window_destroy(Window *window) {
+    if (window->loaded && window->handlers.unload) window->handlers.unload(window);
+    if (s_window == window) s_window = NULL;
+    layer_destroy(window->root_layer);
+    host_free(window);
+}
+
+void window_set_window_handlers(Window *window, WindowHandlers handlers) {
+    window->handlers = handlers;
+}
+
+void window_set_background_color(Window *window, GColor background_color) {
+    window->background = background_color;
+}
+
+Layer *window_get_root_layer(const Window *window) {
+    return window->root_layer;
+}
+
+void window_stack_push(Window *window, bool animated) {
+    s_window = window;
+    if (window->handlers.load) window->handlers.load(window);
+    window->loaded = true;
+    if (window->handlers.appear) window->handlers.appear(window);
+    s_needs_render = true;
+}
+
+static void prv_render_layer(Layer *layer, GPoint offset, GRect clip) {
+    if (layer->hidden) return;
+    GPoint origin = GPoint(offset.x + layer->frame.origin.x, offset.y + layer->frame.origin.y);
+    if (layer->clips) {
+        GRect frame = GRect(origin.x, origin.y, layer->frame.size.w, layer->frame.size.h);
+        grect_clip(&clip, &frame);
+    }
+    if (layer->update_proc) {
+        s_context.origin = origin;
+        s_context.clip = clip;
+        s_context.fill_color = GColorBlack;
+        s_context.compositing = GCompOpAssign;
+        layer->update_proc(layer, &s_context);
+    }
+    for (Layer *child = layer->first_child; child; child = child->next_sibling) prv_render_layer(child, origin, clip);
+}
+
+bool host_needs_render(void) {
+    return s_needs_render && s_window && s_window->loaded;
+}
+
+// Draws the window if anything was marked dirty, as the watch does after each event
+bool host_render(void) {
+    if (!host_needs_render()) return false;
+    s_needs_render = false;
+
+    uint32_t allocs = s_heap.allocs;
+    uint64_t start = host_cycles();
+    GRect screen = GRect(0, 0, PBL_DISPLAY_WIDTH, PBL_DISPLAY_HEIGHT);
+    if (s_window->background.a != 0) {
+        s_context.origin = GPointZero;
+        s_context.clip = screen;
+        s_context.fill_color = s_window->background;
+        graphics_fill_rect(&s_context, screen, 0, GCornerNone);
+    }
+    prv_render_layer(s_window->root_layer, GPointZero, screen);
+    uint64_t cycles = host_cycles() - start;
+
+    s_frame_stats.frames++;
+    s_frame_stats.cycles += cycles;
+    if (cycles > s_frame_stats.max_cycles) s_frame_stats.max_cycles = cycles;
+    s_frame_stats.allocs += s_heap.allocs - allocs;
+    return true;
+}
+
+HostFrameStats host_frame_stats(void) {
+    return s_frame_stats;
+}
+
+void host_frame_stats_reset(void) {
+    memset(&s_frame_stats, 0, sizeof(s_frame_stats));
+}
+
+// Text layers, aplite only. Glyphs are drawn as boxes, enough to cost about the same.
+
+struct FontInfo {
+    const char *key;
+    int16_t height;
+};
+
+static struct FontInfo s_fonts[] = {
+    { FONT_KEY_GOTHIC_18_BOLD, 18 },
+    { FONT_KEY_GOTHIC_24_BOLD, 24 },
+    { FONT_KEY_BITHAM_30_BLACK, 30 },
+    { FONT_KEY_ROBOTO_BOLD_SUBSET_49, 49 },
+};
+
+GFont fonts_get_system_font(const char *font_key) {
+    for (uint i = 0; i < ARRAY_LENGTH(s_fonts); i++) {
+        if (strcmp(s_fonts[i].key, font_key) == 0) return &s_fonts[i];
+    }
+    return &s_fonts[0];
+}
+
+struct TextLayer {
+    Layer *layer;
+    const char *text;
+    GFont font;
+    GColor color;
+    GColor background;
+    GTextAlignment alignment;
+};
+
+static void prv_text_layer_update_proc(Layer *layer, GContext *ctx) {
+    TextLayer *text_layer = *(TextLayer **) layer_get_data(layer);
+    if (text_layer->background.a) {
+        graphics_context_set_fill_color(ctx, text_layer->background);
+        graphics_fill_rect(ctx, layer_get_bounds(layer), 0, GCornerNone);
+    }
+    if (!text_layer->text || !text_layer->font) return;
+
+    int16_t h = text_layer->font->height;
+    int16_t advance = h / 2;
+    int16_t width = strlen(text_layer->text) * advance;
+    int16_t x = 0;
+    if (text_layer->alignment == GTextAlignmentCenter) x = (layer->frame.size.w - width) / 2;
+    else if (text_layer->alignment == GTextAlignmentRight) x = layer->frame.size.w - width;
+
+    graphics_context_set_fill_color(ctx, text_layer->color);
+    for (const char *c = text_layer->text; *c; c++, x += advance) {
+        if (*c != ' ') graphics_fill_rect(ctx, GRect(x + 1, h / 4, advance - 2, h * 3 / 4), 0, GCornerNone);
+    }
+}
+
+TextLayer *text_layer_create(GRect frame) {
+    TextLayer *text_layer = host_calloc(1, sizeof(TextLayer));
+    if (!text_layer) return NULL;
+    text_layer->layer = layer_create_with_data(frame, sizeof(TextLayer *));
+    *(TextLayer **) layer_get_data(text_layer->layer) = text_layer;
+    layer_set_update_proc(text_layer->layer, prv_text_layer_update_proc);
+    text_layer->color = GColorBlack;
+    text_layer->background = GColorWhite;
+    text_layer->font = fonts_get_system_font(FONT_KEY_GOTHIC_18_BOLD);
+    return text_layer;
+}
+
+void text_layer_destroy(TextLayer *text_layer) {
+    layer_destroy(text_layer->layer);
+    host_free(text_layer);
+}
+
+Layer *text_layer_get_layer(TextLayer *text_layer) {
+    return text_layer->layer;
+}
+
+void text_layer_set_text(TextLayer *text_layer, const char *text) {
+    text_layer->text = text;
+    layer_mark_dirty(text_layer->layer);
+}
+
+const char *text_layer_get_text(TextLayer *text_layer) {
+    return text_layer->text;
+}
+
+void text_layer_set_font(TextLayer *text_layer, GFont font) {
+    text_layer->font = font;
+    layer_mark_dirty(text_layer->layer);
+}
+
+void text_layer_set_text_color(TextLayer *text_layer, GColor color) {
+    text_layer->color = color;
+    layer_mark_dirty(text_layer->layer);
+}
+
+void text_layer_set_background_color(TextLayer *text_layer, GColor color) {
+    text_layer->background = color;
+    layer_mark_dirty(text_layer->layer);
+}
+
+void text_layer_set_text_alignment(TextLayer *text_layer, GTextAlignment text_alignment) {
+    text_layer->alignment = text_alignment;
+    layer_mark_dirty(text_layer->layer);
+}
+
+// Animations, one frame every 33 ms. A sequence plays its parts in order and
+// everything is destroyed once it has run, as on the watch.
+
+#define HOST_ANIMATION_MAX_PARTS 4
+#define HOST_ANIMATION_FRAME_MS 33
+
+struct Animation {
+    const AnimationImplementation *implementation;
+    AnimationHandlers handlers;
+    void *context;
+    bool reverse;
+    uint32_t delay_ms;
+    uint32_t duration_ms;
+    Animation *parts[HOST_ANIMATION_MAX_PARTS];
+    uint8_t part_count;
+    uint8_t part;
+    bool started;
+    uint64_t start_ms;
+    AppTimer *timer;
+};
+
+Animation *animation_create(void) {
+    Animation *animation = host_calloc(1, sizeof(Animation));
+    if (animation) animation->duration_ms = ANIMATION_DURATION_DEFAULT_MS;
+    return animation;
+}
+
+bool animation_destroy(Animation *animation) {
+    if (!animation) return false;
+    if (animation->timer) app_timer_cancel(animation->timer);
+    for (uint8_t i = 0; i < animation->part_count; i++) animation_destroy(animation->parts[i]);
+    host_free(animation);
+    return true;
+}
+
+Animation *animation_clone(Animation *from) {
+    Animation *animation = animation_create();
+    if (!animation) return NULL;
+    animation->implementation = from->implementation;
+    animation->handlers = from->handlers;
+    animation->context = from->context;
+    animation->reverse = from->reverse;
+    animation->delay_ms = from->delay_ms;
+    animation->duration_ms = from->duration_ms;
+    return animation;
+}
+
+bool animation_set_implementation(Animation *animation, const AnimationImplementation *implementation) {
+    animation->implementation = implementation;
+    return true;
+}
+
+bool animation_set_handlers(Animation *animation, AnimationHandlers callbacks, void *context) {
+    animation->handlers = callbacks;
+    animation->context = context;
+    return true;
+}
+
+bool animation_set_reverse(Animation *animation, bool reverse) {
+    animation->reverse = reverse;
+    return true;
+}
+
+bool animation_set_delay(Animation *animation, uint32_t delay_ms) {
+    animation->delay_ms = delay_ms;
+    return true;
+}
+
+bool animation_set_duration(Animation *animation, uint32_t duration_ms) {
+    animation->duration_ms = duration_ms;
+    return true;
+}
+
+Animation *animation_sequence_create(Animation *animation_a, Animation *animation_b, Animation *animation_c, ...) {
+    Animation *sequence = animation_create();
+    if (!sequence) return NULL;
+    sequence->duration_ms = 0;
+    Animation *parts[] = { animation_a, animation_b, animation_c };
+    for (uint i = 0; i < ARRAY_LENGTH(parts) && parts[i]; i++) sequence->parts[sequence->part_count++] = parts[i];
+    if (animation_c) {
+        va_list args;
+        va_start(args, animation_c);
+        Animation *part;
+        while ((part = va_arg(args, Animation *)) && sequence->part_count < HOST_ANIMATION_MAX_PARTS) {
+            sequence->parts[sequence->part_count++] = part;
+        }
+        va_end(args);
+    }
+    return sequence;
+}
+
+static void prv_animation_frame(void *data);
+
+static void prv_animation_step(Animation *animation, Animation *part, uint64_t now) {
+    if (!part->started) {
+        if (now < part->start_ms + part->delay_ms) {
+            animation->timer = app_timer_register(part->start_ms + part->delay_ms - now, prv_animation_frame, animation);
+            return;
+        }
+        part->started = true;
+        if (part->handlers.started) part->handlers.started(part, part->context);
+        if (part->implementation && part->implementation->setup) part->implementation->setup(part);
+    }
+
+    uint64_t elapsed = now - part->start_ms - part->delay_ms;
+    bool finished = elapsed >= part->duration_ms;
+    AnimationProgress progress = finished ? ANIMATION_NORMALIZED_MAX :
+                                 (AnimationProgress) (elapsed * ANIMATION_NORMALIZED_MAX / part->duration_ms);
+    if (part->reverse) progress = ANIMATION_NORMALIZED_MAX - progress;
+    if (part->implementation && part->implementation->update) part->implementation->update(part, progress);
+    if (!finished) {
+        animation->timer = app_timer_register(HOST_ANIMATION_FRAME_MS, prv_animation_frame, animation);
+        return;
+    }
+
+    if (part->implementation && part->implementation->teardown) part->implementation->teardown(part);
+    if (part->handlers.stopped) part->handlers.stopped(part, true, part->context);
+    if (part != animation && ++animation->part < animation->part_count) {
+        animation->parts[animation->part]->start_ms = now;
+        prv_animation_step(animation, animation->parts[animation->part], now);
+        return;
+    }
+    if (part != animation && animation->handlers.stopped) animation->handlers.stopped(animation, true, animation->context);
+    animation_destroy(animation);
+}
+
+static void prv_animation_frame(void *data) {
+    Animation *animation = data;
+    animation->timer = NULL;
+    Animation *part = animation->part_count ? animation->parts[animation->part] : animation;
+    prv_animation_step(animation, part, host_now_ms());
+}
+
+bool animation_schedule(Animation *animation) {
+    if (animation->timer || animation->started) return false;
+    animation->start_ms = host_now_ms();
+    if (animation->part_count) {
+        animation->started = true;
+        animation->parts[0]->start_ms = animation->start_ms;
+        if (animation->handlers.started) animation->handlers.started(animation, animation->context);
+    }
+    animation->timer = app_timer_register(0, prv_animation_frame, animation);
+    return true;
+}
+
+bool animation_unschedule(Animation *animation) {
+    if (!animation->timer) return false;
+    app_timer_cancel(animation->timer);
+    animation->timer = NULL;
+    if (animation->handlers.stopped) animation->handlers.stopped(animation, false, animation->context);
+    animation_destroy(animation);
+    return true;
+}
+
+// Services, in whatever state the harness puts them
+
+static BatteryChargeState s_battery = { .charge_percent = 80 };
+static bool s_connected = true;
+
+BatteryChargeState battery_state_service_peek(void) {
+    return s_battery;
+}
+
+void host_battery_set(BatteryChargeState state) {
+    s_battery = state;
+}
+
+bool connection_service_peek_pebble_app_connection(void) {
+    return s_connected;
+}
+
+void host_connection_set(bool connected) {
+    s_connected = connected;
+}
+
+#ifdef PBL_HEALTH
+HealthServiceAccessibilityMask health_service_metric_accessible(HealthMetric metric, time_t time_start, time_t time_end) {
+    return HealthServiceAccessibilityMaskAvailable;
+}
+
+HealthValue health_service_sum_today(HealthMetric metric) {
+    time_t since_midnight = host_time(NULL) - time_start_of_today();
+    switch (metric) {
+        case HealthMetricStepCount: return since_midnight / 8;
+        case HealthMetricWalkedDistanceMeters: return since_midnight / 10;
+        case HealthMetricActiveSeconds: return since_midnight / 12;
+        default: return 0;
+    }
+}
+
+HealthValue health_service_peek_current_value(HealthMetric metric) {
+    return metric == HealthMetricHeartRateBPM ? 64 : 0;
+}
+
+MeasurementSystem health_service_get_measurement_system_for_display(HealthMetric metric) {
+    return MeasurementSystemMetric;
+}
+#endif
+
+// Dictionaries
+
+Tuple *dict_find(const DictionaryIterator *iter, const uint32_t key) {
+    const uint8_t *cursor = iter->begin;
+    while (cursor + sizeof(Tuple) <= iter->end) {
+        Tuple *tuple = (Tuple *) cursor;
+        if (tuple->key == key) return tuple;
+        cursor += sizeof(Tuple) + tuple->length;
+    }
+    return NULL;
+}
+
+// Persistent storage
+
+#define HOST_PERSIST_KEYS 32
+
+typedef struct {
+    bool used;
+    uint32_t key;
+    size_t length;
+    uint8_t data[PERSIST_DATA_MAX_LENGTH];
+} HostPersistEntry;
+
+static HostPersistEntry s_persist[HOST_PERSIST_KEYS];
+static uint32_t s_persist_writes;
+static uint32_t s_persist_write_bytes;
+
+static HostPersistEntry *prv_persist_find(uint32_t key, bool create) {
+    HostPersistEntry *free_entry = NULL;
+    for (uint i = 0; i < HOST_PERSIST_KEYS; i++) {
+        if (s_persist[i].used && s_persist[i].key == key) return &s_persist[i];
+        if (!s_persist[i].used && !free_entry) free_entry = &s_persist[i];
+    }
+    if (!create || !free_entry) return NULL;
+    free_entry->used = true;
+    free_entry->key = key;
+    free_entry->length = 0;
+    return free_entry;
+}
+
+bool persist_exists(const uint32_t key) {
+    return prv_persist_find(key, false) != NULL;
+}
+
+int32_t persist_read_int(const uint32_t key) {
+    int32_t value = 0;
+    persist_read_data(key, &value, sizeof(value));
+    return value;
+}
+
+int persist_read_data(const uint32_t key, void *buffer, const size_t buffer_size) {
+    HostPersistEntry *entry = prv_persist_find(key, false);
+    if (!entry) return E_DOES_NOT_EXIST;
+    size_t length = entry->length < buffer_size ? entry->length : buffer_size;
+    memcpy(buffer, entry->data, length);
+    return length;
+}
+
+int persist_write_int(const uint32_t key, const int32_t value) {
+    return persist_write_data(key, &value, sizeof(value)) < 0 ? -1 : 4;
+}
+
+int persist_write_data(const uint32_t key, const void *data, const size_t size) {
+    HostPersistEntry *entry = prv_persist_find(key, true);
+    if (!entry) return -1;
+    size_t length = size < PERSIST_DATA_MAX_LENGTH ? size : PERSIST_DATA_MAX_LENGTH;
+    memcpy(entry->data, data, length);
+    entry->length = length;
+    s_persist_writes++;
+    s_persist_write_bytes += length;
+    return length;
+}
+
+int persist_delete(const uint32_t key) {
+    HostPersistEntry *entry = prv_persist_find(key, false);
+    if (!entry) return E_DOES_NOT_EXIST;
+    entry->used = false;
+    return 0;
+}
+
+void host_persist_reset(void) {
+    memset(s_persist, 0, sizeof(s_persist));
+    s_persist_writes = 0;
+    s_persist_write_bytes = 0;
+}
+
+uint32_t host_persist_write_count(void) {
+    return s_persist_writes;
+}
+
+uint32_t host_persist_write_bytes(void) {
+    return s_persist_write_bytes;
+}
+
+// Resources, straight from the files package.json names
+
+static const char *const s_resource_files[] = {
+#ifndef PBL_PLATFORM_APLITE
+    [RESOURCE_ID_TEXT_FFONT] = "Lato-Regular.ffont",
+#endif
+    [RESOURCE_ID_WEATHER_CLEAR_DAY] = "WEATHER_CLEAR_DAY.fpath",
+    [RESOURCE_ID_WEATHER_CLEAR_NIGHT] = "WEATHER_CLEAR_NIGHT.fpath",
+    [RESOURCE_ID_WEATHER_PARTLY_CLOUDY_DAY] = "WEATHER_PARTLY_CLOUDY_DAY.fpath",
+    [RESOURCE_ID_WEATHER_PARTLY_CLOUDY_NIGHT] = "WEATHER_PARTLY_CLOUDY_NIGHT.fpath",
+    [RESOURCE_ID_WEATHER_CLOUDY] = "WEATHER_CLOUDY.fpath",
+    [RESOURCE_ID_WEATHER_RAIN] = "WEATHER_RAIN.fpath",
+    [RESOURCE_ID_WEATHER_THUNDER] = "WEATHER_THUNDER.fpath",
+    [RESOURCE_ID_WEATHER_SNOW] = "WEATHER_SNOW.fpath",
+    [RESOURCE_ID_WEATHER_MIST] = "WEATHER_MIST.fpath",
+    [RESOURCE_ID_WEATHER_NA] = "WEATHER_NA.fpath",
+};
+
+static FILE *prv_resource_open(ResHandle h) {
+    uintptr_t id = (uintptr_t) h;
+    if (id >= ARRAY_LENGTH(s_resource_files) || !s_resource_files[id]) return NULL;
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", HOST_RESOURCES_DIR, s_resource_files[id]);
+    return fopen(path, "rb");
+}
+
+ResHandle resource_get_handle(uint32_t resource_id) {
+    return (ResHandle) (uintptr_t) resource_id;
+}
+
+size_t resource_size(ResHandle h) {
+    FILE *file = prv_resource_open(h);
+    if (!file) return 0;
+    fseek(file, 0, SEEK_END);
+    size_t size = ftell(file);
+    fclose(file);
+    return size;
+}
+
+size_t resource_load(ResHandle h, uint8_t *buffer, size_t max_length) {
+    FILE *file = prv_resource_open(h);
+    if (!file) return 0;
+    size_t length = fread(buffer, 1, max_length, file);
+    fclose(file);
+    return length;
+}
+
+void host_sdk_init(void) {
+    clock_gettime(CLOCK_MONOTONIC, &s_real_start);
+    setenv("TZ", "UTC", 1);
+    tzset();
+    const char *level = getenv("HOST_LOG_LEVEL");
+    if (level) s_log_level = atoi(level);
+}
+
+// Writes the screen as a binary PPM, for looking at what the face drew
+bool host_dump_frame(const char *path) {
+    FILE *file = fopen(path, "wb");
+    if (!file) return false;
+    fprintf(file, "P6\n%d %d\n255\n", PBL_DISPLAY_WIDTH, PBL_DISPLAY_HEIGHT);
+    for (int16_t y = 0; y < PBL_DISPLAY_HEIGHT; y++) {
+        for (int16_t x = 0; x < PBL_DISPLAY_WIDTH; x++) {
+            GColor color = prv_bitmap_get(&s_frame_buffer, x, y);
+            uint8_t rgb[3] = { color.r * 85, color.g * 85, color.b * 85 };
+            fwrite(rgb, 1, sizeof(rgb), file);
+        }
+    }
+    fclose(file);
+    return true;
+}
@@ -0,0 +1,262 @@
+// Checks on the face as a whole, built with DEBUG and PROFILE
+#include <pebble.h>
+#include "host.h"
+#include "check.h"
+#include "fctx-layer.h"
+#include "face-config.h"
+#include "ffont-cache.h"
+#include "heap-account.h"
+#include "persist-store.h"
+#include "weather.h"
+
+static void prv_first_frame(void) {
+    HostFrameStats stats = host_frame_stats();
+    check(stats.frames == 1, "%lu frames before the first tick", (unsigned long) stats.frames);
+    check(stats.touched.size.w == PBL_DISPLAY_WIDTH && stats.touched.size.h == PBL_DISPLAY_HEIGHT,
+          "first frame covered %dx%d", stats.touched.size.w, stats.touched.size.h);
+    check(host_startup_cycles() >= stats.cycles, "startup measured without the first frame");
+}
+
+static void prv_weather_arrives(void) {
+    uint32_t fetches = host_weather_fetch_count();
+    host_advance(1000);
+    host_send_app_ready(NULL);
+    host_advance(5000);
+    check(host_weather_fetch_count() == fetches + 1, "no weather fetch after start");
+    GenericWeatherInfo info = host_sample_weather(host_now_ms() / 1000);
+    host_frame_stats_reset();
+    host_send_weather(&info);
+    check(host_frame_stats().frames == 1, "weather reply did not redraw");
+}
+
+// Weather older than what is shown never replaces it, and a live reply still ends its fetch
+static void prv_older_weather_ignored(void) {
+    time_t shown = generic_weather_peek()->timestamp;
+    GenericWeatherInfo older = host_sample_weather(shown - 600);
+    host_send_app_ready(&older);
+    check(generic_weather_peek()->timestamp == shown, "older cached weather replaced newer");
+
+    uint32_t fetches = host_weather_fetch_count();
+    uint32_t warnings = host_log_count(APP_LOG_LEVEL_WARNING);
+    // the refresh timer goes off after the interval, and the fetch a moment later
+    host_advance(face_config_get()->weather_interval * 1000 + 1000);
+    check(host_weather_fetch_count() == fetches + 1, "no weather fetch after the interval");
+    host_send_weather(&older);
+    check(generic_weather_peek()->timestamp == shown, "older live weather replaced newer");
+    host_advance(2 * 60 * 1000);
+    check(host_weather_fetch_count() == fetches + 1 && host_log_count(APP_LOG_LEVEL_WARNING) == warnings,
+          "live reply did not finish the fetch");
+}
+
+#ifndef PBL_PLATFORM_APLITE
+// Once started, redrawing everything must use the fonts already loaded
+static void prv_full_redraw_loads_no_fonts(void) {
+    uint32_t loads = ffont_cache_load_count();
+    int32_t fonts, fonts_peak;
+    heap_account_get(HeapSubsystemFonts, &fonts, &fonts_peak);
+
+    host_frame_stats_reset();
+    host_settings_set("COLOR_TEXT", "FFAA00");
+    host_settings_apply();
+    host_render();
+    HostFrameStats stats = host_frame_stats();
+    check(stats.frames == 1 && stats.touched.size.w == PBL_DISPLAY_WIDTH && stats.touched.size.h == PBL_DISPLAY_HEIGHT,
+          "settings change did not redraw the whole screen");
+    host_advance_to(MINUTE_UNIT);
+
+    int32_t fonts_after, fonts_peak_after;
+    heap_account_get(HeapSubsystemFonts, &fonts_after, &fonts_peak_after);
+    check(ffont_cache_load_count() == loads, "%lu fonts loaded by a full redraw",
+          (unsigned long) (ffont_cache_load_count() - loads));
+    check(fonts_after == fonts && fonts_peak_after == fonts_peak, "font heap went from %ld to %ld, peak %ld",
+          (long) fonts, (long) fonts_after, (long) fonts_peak_after);
+    host_settings_set("COLOR_TEXT", "FFFFFF");
+    host_settings_apply();
+}
+#endif
+
+// One widget changing redraws its own cell, and leaves the same pixels a full redraw would
+static void prv_widget_update_stays_partial(void) {
+    host_settings_set("WIDGET_SE", "5");
+    host_settings_apply();
+    host_render();
+
+    host_frame_stats_reset();
+    host_battery_set((BatteryChargeState) { .charge_percent = 40 });
+    host_fire_battery();
+    host_render();
+    HostFrameStats stats = host_frame_stats();
+    check(stats.frames == 1, "battery change drew %lu frames", (unsigned long) stats.frames);
+    check(stats.touched.size.w > 0 && stats.touched.size.w <= PBL_DISPLAY_WIDTH / 2 && stats.touched.size.h <= 22,
+          "battery widget update covered %d,%d %dx%d", stats.touched.origin.x, stats.touched.origin.y,
+          stats.touched.size.w, stats.touched.size.h);
+
+    GBitmap *fb = host_frame_buffer();
+    size_t size = gbitmap_get_bytes_per_row(fb) * PBL_DISPLAY_HEIGHT;
+    static uint8_t partial[PBL_DISPLAY_WIDTH * PBL_DISPLAY_HEIGHT];
+    memcpy(partial, gbitmap_get_data(fb), size);
+    host_frame_stats_reset();
+    host_settings_apply();
+    host_render();
+    stats = host_frame_stats();
+    check(stats.touched.size.w == PBL_DISPLAY_WIDTH && stats.touched.size.h == PBL_DISPLAY_HEIGHT,
+          "settings did not redraw the whole screen");
+    check(memcmp(partial, gbitmap_get_data(fb), size) == 0, "partial redraw differs from a full one");
+
+    host_settings_set("WIDGET_SE", "4");
+    host_settings_apply();
+    host_render();
+}
+
+// The seconds keep ticking on the second widget page while a tap holds it on screen
+static void prv_scroll_keeps_seconds(void) {
+    host_settings_set("EXTRA_WIDGETS_ENABLED", "true");
+    host_settings_set("EXTRA_WIDGET_SE", "11");
+    host_settings_apply();
+    host_advance_to(SECOND_UNIT);
+
+    host_fire_tap();
+#ifdef PBL_PLATFORM_DIORITE
+    // diorite scrolls on a double tap
+    host_fire_tap();
+#endif
+    host_advance(1500);
+    // the bottom 44 rows, where the scroll holds the second page
+    GBitmap *fb = host_frame_buffer();
+    size_t size = gbitmap_get_bytes_per_row(fb) * 44;
+    uint8_t *rows = gbitmap_get_data(fb) + gbitmap_get_bytes_per_row(fb) * (PBL_DISPLAY_HEIGHT - 44);
+    static uint8_t band[PBL_DISPLAY_WIDTH * 44];
+    memcpy(band, rows, size);
+    host_advance_to(SECOND_UNIT);
+    check(memcmp(band, rows, size) != 0, "seconds froze while scrolled");
+
+    host_advance(6000);
+    host_settings_set("EXTRA_WIDGETS_ENABLED", "false");
+    host_settings_apply();
+    host_render();
+}
+
+static void prv_set_location(const char *name) {
+    host_settings_set("WEATHER_USE_GPS", "false");
+    host_settings_set("WEATHER_LOCATION_NAME", name);
+    host_settings_apply();
+}
+
+// A place asked for again is served from the cache without writing anything, and a
+// reply is kept for the name it was asked for even when the location changed meanwhile
+static void prv_geocode_cache(void) {
+    const GeocodeMapquestCoordinates home = { 51507351, -127758 };
+    const GeocodeMapquestCoordinates office = { 48856613, 2352222 };
+    uint32_t fetches = host_geocode_fetch_count();
+    prv_set_location("Home");
+    host_geocode_reply(&home, GeocodeMapquestStatusAvailable);
+    prv_set_location("Office");
+    // Home again before the reply for Office
+    prv_set_location(" home ");
+    check(host_geocode_fetch_count() == fetches + 2, "%lu geocode fetches for two places",
+          (unsigned long) (host_geocode_fetch_count() - fetches));
+    host_geocode_reply(&office, GeocodeMapquestStatusAvailable);
+    check(host_weather_location().latitude == home.latitude, "location not back home after the office reply");
+
+    uint32_t writes = host_persist_write_count();
+    prv_set_location("Office");
+    check(host_geocode_fetch_count() == fetches + 2, "cached place fetched again");
+    check(host_weather_location().latitude == office.latitude, "office reply not cached for the office");
+    check(host_persist_write_count() == writes, "%lu persist writes for a cache hit",
+          (unsigned long) (host_persist_write_count() - writes));
+
+    host_settings_set("WEATHER_USE_GPS", "true");
+    host_settings_set("WEATHER_LOCATION_NAME", "");
+    host_settings_apply();
+    host_advance(2 * 60 * 1000);
+}
+
+// The forecast hour is shown once it begins, without touching the observed weather
+// the fetch schedule reads or the weather persisted for the next launch
+static void prv_forecast_shown_not_observed(void) {
+    GenericWeatherInfo observed = *generic_weather_peek();
+    time_t now = host_now_ms() / 1000;
+    time_t start = now - now % SECONDS_PER_HOUR + SECONDS_PER_HOUR;
+    GenericWeatherInfo hour = observed;
+    hour.temp_c = observed.temp_c + 5;
+    hour.temp_f = observed.temp_f + 9;
+    hour.condition = GenericWeatherConditionSnow;
+    host_send_forecast(start, 3, &hour);
+    check(weather_peek()->temp_c == observed.temp_c, "forecast shown before its hour");
+
+    host_advance((start - now) * 1000 + 1000);
+    check(weather_peek()->temp_c == hour.temp_c && weather_peek()->condition == GenericWeatherConditionSnow,
+          "forecast hour not shown");
+    check(generic_weather_peek()->temp_c == observed.temp_c && generic_weather_peek()->condition == observed.condition,
+          "forecast overwrote the observed weather");
+    GenericWeatherInfo persisted = { 0 };
+    check(persist_store_get_weather(&persisted) && persisted.temp_c == observed.temp_c,
+          "forecast persisted as observed");
+}
+
+typedef struct {
+    uint16_t draws;
+    uint16_t fills;
+    uint16_t time_draws;
+} ProfileTotals;
+
+static void prv_profile_add(const FctxLayerProfile *profile, void *context) {
+    ProfileTotals *totals = context;
+    totals->draws += profile->draws;
+    totals->fills += profile->fills;
+    if (profile->name && strcmp(profile->name, "time") == 0) totals->time_draws += profile->draws;
+}
+
+// The layer profile reaches the harness, with every fill of a minute tick charged to a layer
+static void prv_profile_collected(void) {
+    ProfileTotals totals = { 0 };
+    fctx_layer_profile_collect(prv_profile_add, &totals);
+    totals = (ProfileTotals) { 0 };
+    host_frame_stats_reset();
+    host_advance_to(MINUTE_UNIT);
+    fctx_layer_profile_collect(prv_profile_add, &totals);
+#ifndef PBL_PLATFORM_APLITE
+    // aplite draws the time with a system text layer, outside any profiled update proc
+    check(totals.time_draws == 1, "time drawn %u times in a minute tick", totals.time_draws);
+#endif
+    check(totals.fills == host_frame_stats().fills, "profile counted %u fills, the frames %lu", totals.fills,
+          (unsigned long) host_frame_stats().fills);
+}
+
+// Every byte in use belongs to a subsystem, spans or not, and the tap stays in budget
+static void prv_heap_accounted(void) {
+#ifndef PBL_PLATFORM_APLITE
+    host_fire_tap();
+    host_advance(3000);
+#endif
+    int32_t total = 0;
+    for (HeapSubsystem i = 0; i < HeapSubsystemEnd; i++) {
+        int32_t current;
+        heap_account_get(i, &current, NULL);
+        total += current;
+    }
+    check(total == (int32_t) heap_bytes_used(), "subsystems account for %ld of %d bytes", (long) total,
+          (int) heap_bytes_used());
+}
+
+static void prv_scenario(void) {
+    prv_first_frame();
+    prv_weather_arrives();
+    prv_older_weather_ignored();
+    prv_profile_collected();
+#ifndef PBL_PLATFORM_APLITE
+    prv_full_redraw_loads_no_fonts();
+    prv_widget_update_stays_partial();
+    prv_scroll_keeps_seconds();
+    prv_geocode_cache();
+#endif
+    prv_forecast_shown_not_observed();
+    prv_heap_accounted();
+    check(host_log_count(APP_LOG_LEVEL_ERROR) == 0, "%lu errors logged", (unsigned long) host_log_count(APP_LOG_LEVEL_ERROR));
+}
+
+int main(void) {
+    host_log_set_level(APP_LOG_LEVEL_ERROR);
+    check(host_run(prv_scenario), "heap over budget");
+    return check_report("test-face");
+}
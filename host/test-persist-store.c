@@ -0,0 +1,183 @@
+// What the persist store writes, read back the way the next launch would
+#include <pebble.h>
+#include "host.h"
+#include "check.h"
+#include "face-config.h"
+#include "persist-store.h"
+
+// The blob under key 5 as versions 1 to 3 wrote it, each appending to the one before
+typedef struct __attribute__((__packed__)) {
+    uint8_t version;
+    uint8_t records;
+    uint8_t status;
+    int32_t timestamp;
+    int32_t timesunrise;
+    int32_t timesunset;
+    int8_t temps[8];
+    uint8_t humidity;
+    uint8_t condition;
+    uint8_t day;
+    GeocodeMapquestCoordinates coordinates;
+    char widgets[FACE_CONFIG_WIDGET_SLOTS][WIDGET_BUF_LEN];
+    struct __attribute__((__packed__)) {
+        uint32_t name_hash;
+        GeocodeMapquestCoordinates coordinates;
+    } places[4];
+} OldBlob;
+
+static const GeocodeMapquestCoordinates s_coordinates = { 51507351, -127758 };
+
+static void prv_relaunch(void) {
+    persist_store_deinit();
+    persist_store_init();
+    persist_store_migrate();
+}
+
+static void prv_round_trip(void) {
+    host_persist_reset();
+    persist_store_init();
+    persist_store_migrate();
+    GenericWeatherInfo info = host_sample_weather(1792227570);
+    persist_store_set_weather(&info, GenericWeatherStatusAvailable);
+    prv_relaunch();
+
+    GenericWeatherInfo restored = { 0 };
+    check(persist_store_get_weather(&restored), "weather not restored");
+    check(restored.timestamp == info.timestamp && restored.temp_c == info.temp_c && restored.condition == info.condition,
+          "weather restored wrong");
+    check(persist_store_get_status() == GenericWeatherStatusAvailable, "status restored as %d", persist_store_get_status());
+    persist_store_deinit();
+}
+
+// A failed fetch is remembered, without losing the weather from before it
+static void prv_failed_status(void) {
+    host_persist_reset();
+    persist_store_init();
+    persist_store_migrate();
+    GenericWeatherInfo info = host_sample_weather(1792227570);
+    persist_store_set_weather(&info, GenericWeatherStatusAvailable);
+    prv_relaunch();
+    persist_store_set_status(GenericWeatherStatusBluetoothDisconnected);
+    prv_relaunch();
+
+    GenericWeatherInfo restored = { 0 };
+    check(persist_store_get_status() == GenericWeatherStatusBluetoothDisconnected, "status restored as %d",
+          persist_store_get_status());
+    check(persist_store_get_weather(&restored) && restored.timestamp == info.timestamp, "weather lost with the status");
+    persist_store_deinit();
+}
+
+// A flush rewrites only the records that changed, and nothing when none did
+static void prv_writes_only_changes(void) {
+    host_persist_reset();
+    persist_store_init();
+    persist_store_migrate();
+    GenericWeatherInfo info = host_sample_weather(1792227570);
+    persist_store_set_weather(&info, GenericWeatherStatusAvailable);
+    for (uint8_t i = 0; i < FACE_CONFIG_WIDGET_SLOTS; i++) persist_store_set_widget_text(i, "HU: 64%");
+    persist_store_set_place(0x1234, &s_coordinates);
+    prv_relaunch();
+
+    uint32_t writes = host_persist_write_count();
+    uint32_t bytes = host_persist_write_bytes();
+    persist_store_set_weather(&info, GenericWeatherStatusAvailable);
+    persist_store_set_widget_text(0, "HU: 64%");
+    prv_relaunch();
+    check(host_persist_write_count() == writes, "%lu writes with nothing changed",
+          (unsigned long) (host_persist_write_count() - writes));
+
+    persist_store_set_status(GenericWeatherStatusFailed);
+    prv_relaunch();
+    check(host_persist_write_count() == writes + 1, "%lu writes for a status change",
+          (unsigned long) (host_persist_write_count() - writes));
+    check(host_persist_write_bytes() - bytes < FACE_CONFIG_WIDGET_SLOTS * WIDGET_BUF_LEN,
+          "status change wrote %lu bytes", (unsigned long) (host_persist_write_bytes() - bytes));
+    const char *text = persist_store_get_widget_text(0);
+    check(text && strcmp(text, "HU: 64%") == 0, "widget text lost");
+    persist_store_deinit();
+}
+
+// Releases before the store kept weather, status and coordinates under keys 2, 3 and 4
+static void prv_legacy_keys(void) {
+    host_persist_reset();
+    GenericWeatherInfo info = host_sample_weather(1792227570);
+    persist_write_data(2, &info, sizeof(info));
+    persist_write_int(3, GenericWeatherStatusAvailable);
+    persist_write_data(4, &s_coordinates, sizeof(s_coordinates));
+
+    persist_store_init();
+    persist_store_migrate();
+    GenericWeatherInfo restored = { 0 };
+    GeocodeMapquestCoordinates coordinates = { 0, 0 };
+    check(persist_store_get_weather(&restored) && restored.timestamp == info.timestamp && restored.temp_f == info.temp_f,
+          "legacy weather not restored");
+    check(persist_store_get_status() == GenericWeatherStatusAvailable, "legacy status restored as %d",
+          persist_store_get_status());
+#ifndef PBL_PLATFORM_APLITE
+    check(persist_store_get_coordinates(&coordinates) && coordinates.latitude == s_coordinates.latitude,
+          "legacy coordinates not restored");
+    check(!persist_exists(4), "legacy coordinates key left behind");
+#endif
+    check(!persist_exists(2) && !persist_exists(3), "legacy keys left behind");
+
+    prv_relaunch();
+    check(persist_store_get_weather(&restored) && restored.timestamp == info.timestamp, "migrated weather not kept");
+    persist_store_deinit();
+}
+
+static void prv_old_version(uint8_t version) {
+    host_persist_reset();
+    OldBlob old;
+    memset(&old, 0, sizeof(old));
+    old.version = version;
+    old.records = 0x1 | 0x2 | 0x4;
+    old.status = GenericWeatherStatusAvailable;
+    old.timestamp = 1792227570;
+    old.temps[0] = 17;
+    old.condition = GenericWeatherConditionRain;
+    old.coordinates = s_coordinates;
+    size_t size = offsetof(OldBlob, widgets);
+    if (version >= 2) {
+        old.records |= 0x8;
+        strcpy(old.widgets[1], "FL: 16");
+        size = offsetof(OldBlob, places);
+    }
+    if (version >= 3) {
+        old.records |= 0x10;
+        old.places[0].name_hash = 0xabcd;
+        old.places[0].coordinates = s_coordinates;
+        size = sizeof(old);
+    }
+    persist_write_data(5, &old, size);
+
+    // restored once straight from the old blob, then again from what it was rewritten as
+    persist_store_init();
+    persist_store_migrate();
+    for (int launch = 0; launch < 2; launch++) {
+        GenericWeatherInfo info = { 0 };
+        GeocodeMapquestCoordinates coordinates = { 0, 0 };
+        check(persist_store_get_weather(&info) && info.timestamp == old.timestamp && info.temp_c == 17 &&
+              info.condition == GenericWeatherConditionRain, "version %d weather restored wrong", version);
+        check(persist_store_get_status() == GenericWeatherStatusAvailable, "version %d status restored as %d", version,
+              persist_store_get_status());
+        check(persist_store_get_coordinates(&coordinates) && coordinates.longitude == s_coordinates.longitude,
+              "version %d coordinates restored wrong", version);
+        const char *text = persist_store_get_widget_text(1);
+        if (version >= 2) check(text && strcmp(text, "FL: 16") == 0, "version %d widget text restored wrong", version);
+        else check(text == NULL, "version %d restored widget text it never had", version);
+        check(persist_store_get_place(0xabcd, &coordinates) == (version >= 3), "version %d place restored wrong", version);
+        prv_relaunch();
+    }
+    persist_store_deinit();
+}
+
+int main(void) {
+    host_sdk_init();
+    host_log_set_level(APP_LOG_LEVEL_ERROR);
+    prv_round_trip();
+    prv_failed_status();
+    prv_writes_only_changes();
+    prv_legacy_keys();
+    for (uint8_t version = 1; version <= 3; version++) prv_old_version(version);
+    return check_report("test-persist-store");
+}
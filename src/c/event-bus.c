@@ -0,0 +1,48 @@
+#include <pebble.h>
+#include "event-bus.h"
+#include "logging.h"
+
+// Handles pack the slot index and its generation, so a handle that was already
+// unsubscribed never matches whoever took the slot over. Index is stored +1 to keep them non-NULL.
+#define EVENT_BUS_HANDLE(index, generation) ((EventHandle) (uintptr_t) (((generation) << 8) | ((index) + 1)))
+#define EVENT_BUS_HANDLE_INDEX(handle) ((int) ((uintptr_t) (handle) & 0xff) - 1)
+#define EVENT_BUS_HANDLE_GENERATION(handle) ((uint8_t) ((uintptr_t) (handle) >> 8))
+
+void event_bus_init(EventBus *this) {
+    logf();
+    memset(this, 0, sizeof(EventBus));
+}
+
+EventHandle event_bus_subscribe(EventBus *this, EventBusHandler handler, void *context) {
+    logf();
+    for (uint i = 0; i < EVENT_BUS_CAPACITY; i++) {
+        EventBusSlot *slot = &this->slots[i];
+        if (slot->handler) continue;
+        slot->handler = handler;
+        slot->context = context;
+        this->count++;
+        return EVENT_BUS_HANDLE(i, slot->generation);
+    }
+    loge("event bus full");
+    return NULL;
+}
+
+bool event_bus_unsubscribe(EventBus *this, EventHandle handle) {
+    logf();
+    int index = EVENT_BUS_HANDLE_INDEX(handle);
+    if (index < 0 || index >= EVENT_BUS_CAPACITY) return false;
+
+    EventBusSlot *slot = &this->slots[index];
+    if (!slot->handler || slot->generation != EVENT_BUS_HANDLE_GENERATION(handle)) return false;
+
+    slot->handler = NULL;
+    slot->context = NULL;
+    slot->generation++;
+    this->count--;
+    return true;
+}
+
+uint8_t event_bus_count(const EventBus *this) {
+    logf();
+    return this->count;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <pebble.h>
+
+typedef void* EventHandle;
+
+#define EVENT_BUS_CAPACITY 4
+
+// Stored untyped, the owning module casts it back to its handler type when dispatching
+typedef void (*EventBusHandler)(void);
+
+typedef struct {
+    EventBusHandler handler;
+    void *context;
+    uint8_t generation;
+} EventBusSlot;
+
+typedef struct {
+    EventBusSlot slots[EVENT_BUS_CAPACITY];
+    uint8_t count;
+} EventBus;
+
+void event_bus_init(EventBus *this);
+EventHandle event_bus_subscribe(EventBus *this, EventBusHandler handler, void *context);
+bool event_bus_unsubscribe(EventBus *this, EventHandle handle);
+uint8_t event_bus_count(const EventBus *this);
@@ -0,0 +1,81 @@
+#include <pebble.h>
+#include <enamel.h>
+#include "face-config.h"
+#include "widgets.h"
+#include "logging.h"
+
+static FaceConfig s_config;
+static EventHandle s_settings_event_handle;
+
+static WidgetType prv_parse_widget(const char *value) {
+    int type = atoi(value);
+    return type > WidgetTypeNone && type < WidgetTypeEnd ? (WidgetType) type : WidgetTypeNone;
+}
+
+static void prv_compile(void) {
+    logf();
+    FaceConfig *config = &s_config;
+
+    config->widgets[0] = prv_parse_widget(enamel_get_WIDGET_NW());
+    config->widgets[1] = prv_parse_widget(enamel_get_WIDGET_NE());
+    config->widgets[2] = prv_parse_widget(enamel_get_WIDGET_SW());
+    config->widgets[3] = prv_parse_widget(enamel_get_WIDGET_SE());
+#ifdef PBL_PLATFORM_APLITE
+    config->extra_widgets = false;
+#else
+    config->extra_widgets = enamel_get_EXTRA_WIDGETS_ENABLED();
+    config->widgets[4] = config->extra_widgets ? prv_parse_widget(enamel_get_EXTRA_WIDGET_NW()) : WidgetTypeNone;
+    config->widgets[5] = config->extra_widgets ? prv_parse_widget(enamel_get_EXTRA_WIDGET_NE()) : WidgetTypeNone;
+    config->widgets[6] = config->extra_widgets ? prv_parse_widget(enamel_get_EXTRA_WIDGET_SW()) : WidgetTypeNone;
+    config->widgets[7] = config->extra_widgets ? prv_parse_widget(enamel_get_EXTRA_WIDGET_SE()) : WidgetTypeNone;
+#endif
+
+    config->visible = 0;
+    config->sources = WidgetSourceNone;
+    config->health_metrics = 0;
+    TimeUnits tick_units = MINUTE_UNIT;
+    for (uint i = 0; i < ARRAY_LENGTH(config->widgets); i++) {
+        WidgetType type = config->widgets[i];
+        if (type == WidgetTypeNone) continue;
+        const WidgetProvider *provider = widget_provider_get(type);
+        config->visible |= 1 << type;
+        config->sources |= provider->source;
+        config->health_metrics |= provider->health_metrics;
+        tick_units |= provider->tick_units;
+    }
+    config->tick_units = (tick_units & SECOND_UNIT) ? SECOND_UNIT : MINUTE_UNIT;
+
+    config->weather_unit = atoi(enamel_get_WEATHER_UNIT()) == 1 ? WeatherUnitFahrenheit : WeatherUnitCelsius;
+    config->connection_vibe = atoi(enamel_get_CONNECTION_VIBE());
+
+    uint32_t interval = atoi(enamel_get_WEATHER_INTERVAL()) * SECONDS_PER_MINUTE;
+    config->weather_interval = interval < (30 * SECONDS_PER_MINUTE) ? (30 * SECONDS_PER_MINUTE) : interval;
+#ifdef PBL_PLATFORM_APLITE
+    config->weather_use_gps = true;
+#else
+    config->weather_use_gps = enamel_get_WEATHER_USE_GPS();
+#endif
+    config->health_interval = atoi(enamel_get_HEALTH_INTERVAL());
+}
+
+static void prv_settings_handler(void *context) {
+    logf();
+    prv_compile();
+}
+
+void face_config_init(void) {
+    logf();
+    prv_compile();
+    // subscribed before any other settings handler so they all see the new config
+    s_settings_event_handle = enamel_settings_received_subscribe(prv_settings_handler, NULL);
+}
+
+void face_config_deinit(void) {
+    logf();
+    enamel_settings_received_unsubscribe(s_settings_event_handle);
+}
+
+const FaceConfig *face_config_get(void) {
+    logg();
+    return &s_config;
+}
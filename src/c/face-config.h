@@ -0,0 +1,34 @@
+#pragma once
+#include <pebble.h>
+#include "widgets.h"
+
+#ifdef PBL_PLATFORM_APLITE
+#define FACE_CONFIG_WIDGET_SLOTS 4
+#else
+#define FACE_CONFIG_WIDGET_SLOTS 8
+#endif
+
+typedef enum {
+    WeatherUnitCelsius = 0,
+    WeatherUnitFahrenheit = 1
+} WeatherUnit;
+
+typedef struct {
+    WidgetType widgets[FACE_CONFIG_WIDGET_SLOTS];
+    // bit n set when a slot shows WidgetType n
+    uint32_t visible;
+    WidgetSource sources;
+    TimeUnits tick_units;
+    uint8_t health_metrics;
+    bool extra_widgets;
+    WeatherUnit weather_unit;
+    uint8_t connection_vibe;
+    uint32_t weather_interval;
+    bool weather_use_gps;
+    // seconds between movement refreshes of the health widgets
+    uint16_t health_interval;
+} FaceConfig;
+
+void face_config_init(void);
+void face_config_deinit(void);
+const FaceConfig *face_config_get(void);
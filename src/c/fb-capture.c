@@ -0,0 +1,90 @@
+#include <pebble.h>
+#include "fb-capture.h"
+#include "logging.h"
+
+// 1-bit captures are copied a byte at a time, so rect.origin.x and any destination x should be multiples of 8
+static uint16_t prv_row_bytes(GBitmapFormat format, int16_t x, int16_t w, int16_t *offset) {
+    if (format == GBitmapFormat1Bit) {
+        *offset = x / 8;
+        return (x + w + 7) / 8 - x / 8;
+    }
+    *offset = x;
+    return w;
+}
+
+GBitmap *fb_capture(GContext *ctx, GRect rect, GBitmap *bitmap) {
+    logf();
+    return fb_capture_into(ctx, rect, bitmap, rect.size, GPointZero);
+}
+
+// Copies rect into a bitmap of the given size at origin, so several regions can be
+// stitched into one bitmap. The bitmap is reused if it already has that size and format.
+GBitmap *fb_capture_into(GContext *ctx, GRect rect, GBitmap *bitmap, GSize size, GPoint origin) {
+    logf();
+    GBitmap *fb = graphics_capture_frame_buffer(ctx);
+    if (!fb) return bitmap;
+
+    GBitmapFormat format = gbitmap_get_format(fb);
+    if (bitmap) {
+        GRect bounds = gbitmap_get_bounds(bitmap);
+        if (!gsize_equal(&bounds.size, &size) || gbitmap_get_format(bitmap) != format) {
+            gbitmap_destroy(bitmap);
+            bitmap = NULL;
+        }
+    }
+    if (!bitmap) bitmap = gbitmap_create_blank(size, format);
+    if (!bitmap) {
+        loge("failed to allocate capture bitmap");
+        graphics_release_frame_buffer(ctx, fb);
+        return NULL;
+    }
+
+    int16_t offset;
+    int16_t dst_offset;
+    uint16_t len = prv_row_bytes(format, rect.origin.x, rect.size.w, &offset);
+    prv_row_bytes(format, origin.x, rect.size.w, &dst_offset);
+    uint16_t fb_stride = gbitmap_get_bytes_per_row(fb);
+    uint16_t stride = gbitmap_get_bytes_per_row(bitmap);
+    uint16_t max_len = stride - dst_offset;
+    int16_t rows = rect.size.h < size.h - origin.y ? rect.size.h : size.h - origin.y;
+    uint8_t *src = gbitmap_get_data(fb) + rect.origin.y * fb_stride + offset;
+    uint8_t *dst = gbitmap_get_data(bitmap) + origin.y * stride + dst_offset;
+    for (int16_t y = 0; y < rows; y++) {
+        memcpy(dst, src, len < max_len ? len : max_len);
+        src += fb_stride;
+        dst += stride;
+    }
+
+    graphics_release_frame_buffer(ctx, fb);
+    return bitmap;
+}
+
+// Points the frame buffer at bitmap until fb_redirect_end, so what fctx fills in between
+// lands in bitmap instead of on screen, clipped to its bounds. bitmap must have the
+// frame buffer's format. Only fctx drawing may happen in between: the GContext's own
+// drawing box still assumes the screen.
+bool fb_redirect_begin(GContext *ctx, GBitmap *bitmap, FbRedirect *saved) {
+    logf();
+    GBitmap *fb = graphics_capture_frame_buffer(ctx);
+    if (!fb) return false;
+    if (gbitmap_get_format(bitmap) != gbitmap_get_format(fb)) {
+        graphics_release_frame_buffer(ctx, fb);
+        return false;
+    }
+    saved->data = gbitmap_get_data(fb);
+    saved->stride = gbitmap_get_bytes_per_row(fb);
+    saved->bounds = gbitmap_get_bounds(fb);
+    gbitmap_set_data(fb, gbitmap_get_data(bitmap), gbitmap_get_format(fb), gbitmap_get_bytes_per_row(bitmap), false);
+    gbitmap_set_bounds(fb, gbitmap_get_bounds(bitmap));
+    graphics_release_frame_buffer(ctx, fb);
+    return true;
+}
+
+void fb_redirect_end(GContext *ctx, const FbRedirect *saved) {
+    logf();
+    GBitmap *fb = graphics_capture_frame_buffer(ctx);
+    if (!fb) return;
+    gbitmap_set_data(fb, saved->data, gbitmap_get_format(fb), saved->stride, false);
+    gbitmap_set_bounds(fb, saved->bounds);
+    graphics_release_frame_buffer(ctx, fb);
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include <pebble.h>
+
+GBitmap *fb_capture(GContext *ctx, GRect rect, GBitmap *bitmap);
+GBitmap *fb_capture_into(GContext *ctx, GRect rect, GBitmap *bitmap, GSize size, GPoint origin);
+
+typedef struct {
+    uint8_t *data;
+    uint16_t stride;
+    GRect bounds;
+} FbRedirect;
+
+bool fb_redirect_begin(GContext *ctx, GBitmap *bitmap, FbRedirect *saved);
+void fb_redirect_end(GContext *ctx, const FbRedirect *saved);
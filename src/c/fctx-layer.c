@@ -1,76 +1,388 @@
 #include <pebble.h>
 #include <pebble-fctx/fctx.h>
-#include <@smallstoneapps/linked-list/linked-list.h>
 #include "fctx-layer.h"
+#include "fb-capture.h"
+#include "heap-account.h"
 #include "logging.h"
 
+typedef struct {
+    GColor background;
+    FctxLayerUpdateProc background_proc;
+    GBitmap *background_bitmap;
+    bool background_valid;
+    GRect dirty;
+    bool partial;
+} FctxRootState;
+
 struct FctxLayer {
     Layer *layer;
     FctxLayerUpdateProc update_proc;
     FctxLayer *parent;
-    LinkedRoot *children;
+    // pool indices in z-order
+    uint8_t children[FCTX_LAYER_MAX_CHILDREN];
+    uint8_t child_count;
+    uint8_t index;
+    bool in_use;
     void *data;
+    GRect damage;
+    GRect drawn_frame;
+    bool drawn_hidden;
+    FctxRootState *root_state;
+#ifdef PROFILE
+    FctxLayerProfile profile;
+#endif
 };
 
-static bool prv_layer_children_foreach(void *obj, void *fctx) {
+// One block holding every layer and its data, slot_size apart
+static uint8_t *s_pool;
+static uint8_t s_pool_count;
+static size_t s_pool_data_size;
+static size_t s_pool_slot_size;
+
+// shifts drawing while fctx_layer_draw renders a subtree somewhere else
+static GPoint s_draw_offset;
+
+static const GRect s_screen = { { 0, 0 }, { PBL_DISPLAY_WIDTH, PBL_DISPLAY_HEIGHT } };
+
+static bool prv_grect_contains(GRect a, GRect b) {
+    return b.origin.x >= a.origin.x && b.origin.y >= a.origin.y &&
+           b.origin.x + b.size.w <= a.origin.x + a.size.w && b.origin.y + b.size.h <= a.origin.y + a.size.h;
+}
+
+static GRect prv_grect_union(GRect a, GRect b) {
+    if (grect_is_empty(&a)) return b;
+    if (grect_is_empty(&b)) return a;
+    int16_t x1 = a.origin.x < b.origin.x ? a.origin.x : b.origin.x;
+    int16_t y1 = a.origin.y < b.origin.y ? a.origin.y : b.origin.y;
+    int16_t x2 = a.origin.x + a.size.w > b.origin.x + b.size.w ? a.origin.x + a.size.w : b.origin.x + b.size.w;
+    int16_t y2 = a.origin.y + a.size.h > b.origin.y + b.size.h ? a.origin.y + a.size.h : b.origin.y + b.size.h;
+    return GRect(x1, y1, x2 - x1, y2 - y1);
+}
+
+#ifdef PROFILE
+#define FCTX_LAYER_PROFILE_DEPTH 8
+
+// Layers being drawn, innermost last, with the time charged to each so far.
+// fctx_layer_draw nests a whole subtree inside another layer's update proc.
+typedef struct {
+    FctxLayerProfile *profile;
+    uint32_t ms;
+} FctxLayerProfileSpan;
+
+static FctxLayerProfileSpan s_profile_stack[FCTX_LAYER_PROFILE_DEPTH];
+static uint8_t s_profile_depth;
+static uint32_t s_profile_mark;
+
+static uint32_t prv_time_ms(void) {
+    time_t seconds;
+    uint16_t ms;
+    time_ms(&seconds, &ms);
+    return seconds * 1000 + ms;
+}
+
+static FctxLayerProfileClock s_profile_clock = prv_time_ms;
+
+// Charges the time since the previous mark to the innermost layer. Consecutive
+// readings add up exactly, so over many frames each layer gets its share of every
+// millisecond tick, even when a single draw is shorter than one.
+static void prv_profile_charge(void) {
+    uint32_t now = s_profile_clock();
+    if (s_profile_depth > 0) s_profile_stack[s_profile_depth - 1].ms += now - s_profile_mark;
+    s_profile_mark = now;
+}
+
+static bool prv_profile_begin(FctxLayer *this) {
+    prv_profile_charge();
+    if (s_profile_depth == FCTX_LAYER_PROFILE_DEPTH) return false;
+    s_profile_stack[s_profile_depth++] = (FctxLayerProfileSpan) { &this->profile, 0 };
+    return true;
+}
+
+static void prv_profile_end(bool begun) {
+    prv_profile_charge();
+    if (!begun) return;
+    FctxLayerProfileSpan *span = &s_profile_stack[--s_profile_depth];
+    FctxLayerProfile *profile = span->profile;
+    profile->draws++;
+    profile->total_ms += span->ms;
+    if (span->ms > profile->max_ms) profile->max_ms = span->ms;
+}
+#endif
+
+static FctxLayer *prv_slot(uint8_t index) {
+    return (FctxLayer *) (s_pool + index * s_pool_slot_size);
+}
+
+static FctxLayer *prv_child(const FctxLayer *this, uint8_t i) {
+    return prv_slot(this->children[i]);
+}
+
+static FctxLayer *prv_root(FctxLayer *this) {
+    while (this->parent) this = this->parent;
+    return this;
+}
+
+static GRect prv_draw_frame(const FctxLayer *this) {
+    GRect frame = layer_get_frame(this->layer);
+    if (this->parent != NULL) {
+        GRect parent = layer_get_frame(this->parent->layer);
+        frame.origin.x += parent.origin.x;
+        frame.origin.y += parent.origin.y;
+    }
+    return frame;
+}
+
+static GRect prv_draw_damage(const FctxLayer *this) {
+    GRect frame = prv_draw_frame(this);
+    GRect damage = this->damage;
+    damage.origin.x += frame.origin.x;
+    damage.origin.y += frame.origin.y;
+    grect_clip(&damage, &s_screen);
+    return damage;
+}
+
+static GPoint prv_draw_origin(const FctxLayer *this) {
+    GPoint origin = prv_draw_frame(this).origin;
+    origin.x += s_draw_offset.x;
+    origin.y += s_draw_offset.y;
+    return origin;
+}
+
+static void prv_draw_layer(FctxLayer *this, FContext *fctx) {
+    fctx_set_scale(fctx, FPointOne, FPointOne);
+    fctx_set_rotation(fctx, 0);
+    fctx_set_offset(fctx, g2fpoint(prv_draw_origin(this)));
+#ifdef PROFILE
+    bool begun = prv_profile_begin(this);
+#endif
+    this->update_proc(this, fctx);
+#ifdef PROFILE
+    prv_profile_end(begun);
+#endif
+}
+
+static void prv_draw_children(FctxLayer *this, FContext *fctx) {
     logf();
-    FctxLayer *this = (FctxLayer *) obj;
-    bool hidden = fctx_layer_get_hidden(this);
-    if (this->update_proc && !hidden) {
-        fctx_set_scale(fctx, FPointOne, FPointOne);
-        fctx_set_rotation(fctx, 0);
+    for (uint8_t i = 0; i < this->child_count; i++) {
+        FctxLayer *child = prv_child(this, i);
+        bool hidden = layer_get_hidden(child->layer);
+        child->drawn_frame = prv_draw_frame(child);
+        child->drawn_hidden = hidden;
+        if (hidden) continue;
+        if (child->update_proc) prv_draw_layer(child, fctx);
+        if (child->child_count) prv_draw_children(child, fctx);
+    }
+}
+
+static void prv_draw_tree(FctxLayer *this, FContext *fctx) {
+    if (layer_get_hidden(this->layer)) return;
+    if (this->update_proc) prv_draw_layer(this, fctx);
+    for (uint8_t i = 0; i < this->child_count; i++) prv_draw_tree(prv_child(this, i), fctx);
+}
+
+#ifndef PBL_PLATFORM_APLITE
+// Damage boxes are rounded outwards, so boxes that share a strip this thin or thinner
+// have no ink in common and neither is pulled into the other's redraw
+#define FCTX_LAYER_DAMAGE_SLACK 2
+
+static bool prv_grect_overlaps(GRect a, GRect b) {
+    int16_t w = (a.origin.x + a.size.w < b.origin.x + b.size.w ? a.origin.x + a.size.w : b.origin.x + b.size.w) -
+                (a.origin.x > b.origin.x ? a.origin.x : b.origin.x);
+    int16_t h = (a.origin.y + a.size.h < b.origin.y + b.size.h ? a.origin.y + a.size.h : b.origin.y + b.size.h) -
+                (a.origin.y > b.origin.y ? a.origin.y : b.origin.y);
+    return w > FCTX_LAYER_DAMAGE_SLACK && h > FCTX_LAYER_DAMAGE_SLACK;
+}
 
-        GRect frame = fctx_layer_get_frame(this);
-        if (this->parent != NULL) {
-            GRect parent = fctx_layer_get_frame(this->parent);
-            frame.origin.x += parent.origin.x;
-            frame.origin.y += parent.origin.y;
+static bool prv_children_moved(const FctxLayer *this) {
+    for (uint8_t i = 0; i < this->child_count; i++) {
+        FctxLayer *child = prv_child(this, i);
+        GRect frame = prv_draw_frame(child);
+        bool hidden = layer_get_hidden(child->layer);
+        if (hidden != child->drawn_hidden || !grect_equal(&frame, &child->drawn_frame)) return true;
+        if (!hidden && prv_children_moved(child)) return true;
+    }
+    return false;
+}
+
+static bool prv_children_expand(const FctxLayer *this, GRect *dirty) {
+    bool changed = false;
+    for (uint8_t i = 0; i < this->child_count; i++) {
+        FctxLayer *child = prv_child(this, i);
+        if (layer_get_hidden(child->layer)) continue;
+        if (child->update_proc) {
+            GRect damage = prv_draw_damage(child);
+            if (prv_grect_overlaps(*dirty, damage) && !prv_grect_contains(*dirty, damage)) {
+                *dirty = prv_grect_union(*dirty, damage);
+                changed = true;
+            }
         }
-        fctx_set_offset(fctx, g2fpoint(frame.origin));
+        if (prv_children_expand(child, dirty)) changed = true;
+    }
+    return changed;
+}
+
+// Records what was drawn the same way prv_draw_children does, so the next
+// prv_children_moved compares against this frame
+static void prv_children_redraw(FctxLayer *this, GRect dirty, FContext *fctx) {
+    for (uint8_t i = 0; i < this->child_count; i++) {
+        FctxLayer *child = prv_child(this, i);
+        bool hidden = layer_get_hidden(child->layer);
+        child->drawn_frame = prv_draw_frame(child);
+        child->drawn_hidden = hidden;
+        if (hidden) continue;
+        GRect damage = prv_draw_damage(child);
+        if (child->update_proc && !grect_is_empty(&damage) && prv_grect_contains(dirty, damage)) prv_draw_layer(child, fctx);
+        if (child->child_count) prv_children_redraw(child, dirty, fctx);
+    }
+}
 
-        this->update_proc(this, fctx);
+static bool prv_partial_update(FctxLayer *this, GContext *ctx) {
+    FctxRootState *state = this->root_state;
+    GRect dirty = state->dirty;
+
+    if (prv_children_moved(this)) return false;
+
+    // grow the region until every layer that touches it lies entirely inside,
+    // so nothing is blended twice over stale pixels
+    while (prv_children_expand(this, &dirty));
+    if (prv_grect_contains(dirty, s_screen)) return false;
+
+    if (state->background_bitmap) {
+        gbitmap_set_bounds(state->background_bitmap, dirty);
+        graphics_draw_bitmap_in_rect(ctx, state->background_bitmap, dirty);
+        gbitmap_set_bounds(state->background_bitmap, s_screen);
+    } else {
+        graphics_context_set_fill_color(ctx, state->background);
+        graphics_fill_rect(ctx, dirty, 0, GCornerNone);
     }
-    if (this->children && !hidden) linked_list_foreach(this->children, prv_layer_children_foreach, fctx);
+
+    FContext fctx;
+    fctx_init_context(&fctx, ctx);
+    prv_children_redraw(this, dirty, &fctx);
+    fctx_deinit_context(&fctx);
     return true;
 }
+#endif
 
 static void prv_update_proc(Layer *layer, GContext *ctx) {
     logf();
-    FctxLayer *this = layer_get_data(layer);
+    FctxLayer *this = *(FctxLayer **) layer_get_data(layer);
+    FctxRootState *state = this->root_state;
+
+#ifndef PBL_PLATFORM_APLITE
+    bool partial = state->partial && !gcolor_equal(state->background, GColorClear) &&
+                   (!state->background_proc || state->background_valid);
+    state->partial = false;
+    logv(partial, state->dirty.size.h);
+    if (partial && prv_partial_update(this, ctx)) {
+        state->dirty = GRectZero;
+        return;
+    }
+#endif
+    state->dirty = GRectZero;
+
+    if (state->background_bitmap && state->background_valid) {
+        graphics_draw_bitmap_in_rect(ctx, state->background_bitmap, s_screen);
+    } else if (!gcolor_equal(state->background, GColorClear)) {
+        graphics_context_set_fill_color(ctx, state->background);
+        graphics_fill_rect(ctx, s_screen, 0, GCornerNone);
+    }
 
     FContext fctx;
     fctx_init_context(&fctx, ctx);
-    linked_list_foreach(this->children, prv_layer_children_foreach, &fctx);
+    if (state->background_proc && !state->background_valid) {
+        fctx_set_scale(&fctx, FPointOne, FPointOne);
+        fctx_set_rotation(&fctx, 0);
+        fctx_set_offset(&fctx, FPointI(0, 0));
+#ifdef PROFILE
+        bool begun = prv_profile_begin(this);
+#endif
+        state->background_proc(this, &fctx);
+#ifdef PROFILE
+        prv_profile_end(begun);
+#endif
+        heap_account_begin(HeapSubsystemLayers);
+        state->background_bitmap = fb_capture(ctx, s_screen, state->background_bitmap);
+        heap_account_end();
+        state->background_valid = state->background_bitmap != NULL;
+    }
+    prv_draw_children(this, &fctx);
     fctx_deinit_context(&fctx);
 }
 
+// Sizes the pool every FctxLayer is taken from, data_size being the largest
+// fctx_layer_create_with_data size that will be asked for
+void fctx_layer_pool_init(uint8_t count, size_t data_size) {
+    logf();
+    s_pool_data_size = (data_size + 3) & ~3;
+    s_pool_slot_size = ((sizeof(FctxLayer) + 3) & ~3) + s_pool_data_size;
+    s_pool = malloc(count * s_pool_slot_size);
+    s_pool_count = s_pool ? count : 0;
+    if (s_pool) memset(s_pool, 0, count * s_pool_slot_size);
+}
+
+void fctx_layer_pool_deinit(void) {
+    logf();
+    free(s_pool);
+    s_pool = NULL;
+    s_pool_count = 0;
+}
+
+static FctxLayer *prv_create(Layer *layer, size_t size) {
+    logf();
+    if (!layer) return NULL;
+    if (size > s_pool_data_size) {
+        loge("fctx layer data too large: %d", (int) size);
+        layer_destroy(layer);
+        return NULL;
+    }
+
+    for (uint8_t i = 0; i < s_pool_count; i++) {
+        FctxLayer *this = prv_slot(i);
+        if (this->in_use) continue;
+        memset(this, 0, sizeof(FctxLayer));
+        this->in_use = true;
+        this->index = i;
+        this->layer = layer;
+        this->data = size ? (uint8_t *) this + (s_pool_slot_size - s_pool_data_size) : NULL;
+        GRect frame = layer_get_frame(layer);
+        this->damage = GRect(0, 0, frame.size.w, frame.size.h);
+        return this;
+    }
+
+    loge("fctx layer pool exhausted");
+    layer_destroy(layer);
+    return NULL;
+}
+
 FctxLayer *window_get_root_fctx_layer(const Window *window) {
     logf();
     Layer *root_layer = window_get_root_layer(window);
-    FctxLayer *this = fctx_layer_create(GRect(0, 0, PBL_DISPLAY_WIDTH, PBL_DISPLAY_HEIGHT));
+    // the root keeps a pointer back to its FctxLayer for prv_update_proc
+    Layer *layer = layer_create_with_data(GRect(0, 0, PBL_DISPLAY_WIDTH, PBL_DISPLAY_HEIGHT), sizeof(FctxLayer *));
+    FctxLayer *this = prv_create(layer, 0);
+    if (!this) return NULL;
+    *(FctxLayer **) layer_get_data(layer) = this;
     layer_set_update_proc(this->layer, prv_update_proc);
     layer_add_child(root_layer, this->layer);
-    this->children = linked_list_create_root();
+    this->root_state = malloc(sizeof(FctxRootState));
+    this->root_state->background = GColorClear;
+    this->root_state->background_proc = NULL;
+    this->root_state->background_bitmap = NULL;
+    this->root_state->background_valid = false;
+    this->root_state->dirty = GRectZero;
+    this->root_state->partial = false;
     return this;
 }
 
 FctxLayer *fctx_layer_create(const GRect frame) {
     logf();
-    Layer *layer = layer_create_with_data(frame, sizeof(FctxLayer));
-    FctxLayer *this = layer_get_data(layer);
-    this->layer = layer;
-    this->update_proc = NULL;
-    this->parent = NULL;
-    this->children = NULL;
-    this->data = NULL;
-    return this;
+    return prv_create(layer_create(frame), 0);
 }
 
 FctxLayer *fctx_layer_create_with_data(const GRect frame, const size_t size) {
     logf();
-    FctxLayer *this = fctx_layer_create(frame);
-    this->data = malloc(size);
-    return this;
+    return prv_create(layer_create(frame), size);
 }
 
 void fctx_layer_set_update_proc(FctxLayer *this, FctxLayerUpdateProc update_proc) {
@@ -82,33 +394,39 @@ void fctx_layer_destroy(FctxLayer *this) {
     logf();
     fctx_layer_remove_from_parent(this);
 
-    if (this->data) free(this->data);
+    for (uint8_t i = 0; i < this->child_count; i++) prv_child(this, i)->parent = NULL;
+    this->child_count = 0;
     this->data = NULL;
 
-    if (this->children) free(this->children);
-    this->children = NULL;
+    if (this->root_state && this->root_state->background_bitmap) gbitmap_destroy(this->root_state->background_bitmap);
+    if (this->root_state) free(this->root_state);
+    this->root_state = NULL;
 
     this->update_proc = NULL;
 
     Layer *layer = this->layer;
     this->layer = NULL;
+    this->in_use = false;
     layer_destroy(layer);
 }
 
 Layer *fctx_layer_get_layer(const FctxLayer *this) {
-    logf();
+    logg();
     return this->layer;
 }
 
 void *fctx_layer_get_data(const FctxLayer *this) {
-    logf();
+    logg();
     return this->data;
 }
 
 void fctx_layer_add_child(FctxLayer *this, FctxLayer *child) {
     logf();
-    if (!this->children) this->children = linked_list_create_root();
-    linked_list_append(this->children, child);
+    if (this->child_count >= FCTX_LAYER_MAX_CHILDREN) {
+        loge("fctx layer has too many children");
+        return;
+    }
+    this->children[this->child_count++] = child->index;
     child->parent = this;
     layer_add_child(this->layer, child->layer);
 }
@@ -118,26 +436,65 @@ void fctx_layer_remove_from_parent(FctxLayer *this) {
     if (!this->parent) return;
 
     FctxLayer *parent = this->parent;
-    int16_t index = linked_list_find(parent->children, this);
-    if (index > -1) {
+    for (uint8_t i = 0; i < parent->child_count; i++) {
+        if (parent->children[i] != this->index) continue;
+        memmove(&parent->children[i], &parent->children[i + 1], parent->child_count - i - 1);
+        parent->child_count--;
         layer_remove_from_parent(this->layer);
-        linked_list_remove(parent->children, index);
         this->parent = NULL;
+        return;
+    }
+}
 
-        if (linked_list_count(parent->children) == 0) {
-            free(parent->children);
-            parent->children = NULL;
+void fctx_layer_mark_dirty(FctxLayer *this) {
+    logf();
+    FctxLayer *root = prv_root(this);
+    FctxRootState *state = root->root_state;
+    if (state) {
+        if (root == this) {
+            state->dirty = s_screen;
+        } else if (!prv_grect_contains(state->dirty, s_screen)) {
+            if (grect_is_empty(&state->dirty)) state->partial = true;
+            state->dirty = prv_grect_union(state->dirty, prv_draw_damage(this));
         }
     }
+    layer_mark_dirty(root->layer);
 }
 
-void fctx_layer_mark_dirty(const FctxLayer *this) {
+void fctx_layer_set_damage(FctxLayer *this, GRect damage) {
     logf();
-    layer_mark_dirty(this->layer);
+    if (grect_equal(&this->damage, &damage)) return;
+    fctx_layer_mark_dirty(this);
+    this->damage = damage;
+    fctx_layer_mark_dirty(this);
 }
 
-bool fctx_layer_get_hidden(const FctxLayer *this) {
+void fctx_layer_set_background_color(FctxLayer *this, GColor color) {
+    logf();
+    FctxLayer *root = prv_root(this);
+    if (!root->root_state || gcolor_equal(root->root_state->background, color)) return;
+    root->root_state->background = color;
+    fctx_layer_invalidate_background(root);
+}
+
+void fctx_layer_set_background_update_proc(FctxLayer *this, FctxLayerUpdateProc update_proc) {
+    logf();
+    FctxLayer *root = prv_root(this);
+    if (!root->root_state) return;
+    root->root_state->background_proc = update_proc;
+    fctx_layer_invalidate_background(root);
+}
+
+void fctx_layer_invalidate_background(FctxLayer *this) {
     logf();
+    FctxLayer *root = prv_root(this);
+    if (!root->root_state) return;
+    root->root_state->background_valid = false;
+    fctx_layer_mark_dirty(root);
+}
+
+bool fctx_layer_get_hidden(const FctxLayer *this) {
+    logg();
     return layer_get_hidden(this->layer);
 }
 
@@ -147,17 +504,33 @@ void fctx_layer_set_hidden(FctxLayer *this, bool hidden) {
 }
 
 GRect fctx_layer_get_frame(const FctxLayer *this) {
-    logf();
+    logg();
     return layer_get_frame(this->layer);
 }
 
+GPoint fctx_layer_get_draw_origin(const FctxLayer *this) {
+    logg();
+    return prv_draw_origin(this);
+}
+
+// Draws a layer and its children shifted by offset, outside of the normal pass and
+// without recording anything for partial redraw. Meant for update procs that compose
+// other layers into an offscreen capture.
+void fctx_layer_draw(FctxLayer *this, FContext *fctx, GPoint offset) {
+    logf();
+    GPoint previous = s_draw_offset;
+    s_draw_offset = GPoint(previous.x + offset.x, previous.y + offset.y);
+    prv_draw_tree(this, fctx);
+    s_draw_offset = previous;
+}
+
 void fctx_layer_set_frame(FctxLayer *this, GRect frame) {
     logf();
     layer_set_frame(this->layer, frame);
 }
 
 GRect fctx_layer_get_bounds(const FctxLayer *this) {
-    logf();
+    logg();
     return layer_get_bounds(this->layer);
 }
 
@@ -165,3 +538,55 @@ void fctx_layer_set_bounds(FctxLayer *this, GRect bounds) {
     logf();
     layer_set_bounds(this->layer, bounds);
 }
+
+#ifdef PROFILE
+static void prv_profile_log(const FctxLayerProfile *profile, void *context) {
+    logi("%s: %u draws, %u fills, %lu ms total, %u ms max", profile->name ? profile->name : "unnamed",
+         profile->draws, profile->fills, profile->total_ms, profile->max_ms);
+}
+
+static void prv_profile_take(FctxLayer *this, FctxLayerProfileHandler handler, void *context) {
+    FctxLayerProfile *profile = &this->profile;
+    if (profile->draws > 0) handler(profile, context);
+    const char *name = profile->name;
+    memset(profile, 0, sizeof(FctxLayerProfile));
+    profile->name = name;
+}
+
+static void prv_profile_report(FctxLayer *this) {
+    prv_profile_take(this, prv_profile_log, NULL);
+    for (uint8_t i = 0; i < this->child_count; i++) prv_profile_report(prv_child(this, i));
+}
+
+void fctx_layer_set_name(FctxLayer *this, const char *name) {
+    logf();
+    this->profile.name = name;
+}
+
+// Called after every fill so it is attributed to the layer being drawn
+void fctx_layer_profile_fill(void) {
+    if (s_profile_depth > 0) s_profile_stack[s_profile_depth - 1].profile->fills++;
+}
+
+// Replaces the millisecond clock, for hosts where wall time says nothing about cost
+void fctx_layer_profile_set_clock(FctxLayerProfileClock clock) {
+    logf();
+    s_profile_clock = clock ? clock : prv_time_ms;
+    s_profile_mark = s_profile_clock();
+}
+
+// Hands the counters of every layer that drew to handler, in creation order, then resets them
+void fctx_layer_profile_collect(FctxLayerProfileHandler handler, void *context) {
+    logf();
+    for (uint8_t i = 0; i < s_pool_count; i++) {
+        FctxLayer *this = prv_slot(i);
+        if (this->in_use) prv_profile_take(this, handler, context);
+    }
+}
+
+// Logs and resets the counters of this layer and everything below it
+void fctx_layer_profile_report(FctxLayer *this) {
+    logf();
+    prv_profile_report(this);
+}
+#endif
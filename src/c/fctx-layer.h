@@ -2,9 +2,13 @@
 #include <pebble.h>
 #include <pebble-fctx/fctx.h>
 
+#define FCTX_LAYER_MAX_CHILDREN 8
+
 typedef struct FctxLayer FctxLayer;
 typedef void (*FctxLayerUpdateProc)(struct FctxLayer *this, FContext* fctx);
 
+void fctx_layer_pool_init(uint8_t count, size_t data_size);
+void fctx_layer_pool_deinit(void);
 FctxLayer *window_get_root_fctx_layer(const Window *window);
 FctxLayer *fctx_layer_create(const GRect frame);
 FctxLayer *fctx_layer_create_with_data(const GRect frame, const size_t size);
@@ -15,13 +19,45 @@ Layer *fctx_layer_get_layer(const FctxLayer *this);
 void *fctx_layer_get_data(const FctxLayer *this);
 void fctx_layer_add_child(FctxLayer *this, FctxLayer *child);
 void fctx_layer_remove_from_parent(FctxLayer *this);
-void fctx_layer_mark_dirty(const FctxLayer *this);
+void fctx_layer_mark_dirty(FctxLayer *this);
+void fctx_layer_set_damage(FctxLayer *this, GRect damage);
+void fctx_layer_set_background_color(FctxLayer *this, GColor color);
+void fctx_layer_set_background_update_proc(FctxLayer *this, FctxLayerUpdateProc update_proc);
+void fctx_layer_invalidate_background(FctxLayer *this);
 
 bool fctx_layer_get_hidden(const FctxLayer *this);
 void fctx_layer_set_hidden(FctxLayer *this, bool hidden);
 
 GRect fctx_layer_get_frame(const FctxLayer *this);
+GPoint fctx_layer_get_draw_origin(const FctxLayer *this);
+void fctx_layer_draw(FctxLayer *this, FContext *fctx, GPoint offset);
 void fctx_layer_set_frame(FctxLayer *this, GRect frame);
 
 GRect fctx_layer_get_bounds(const FctxLayer *this);
 void fctx_layer_set_bounds(FctxLayer *this, GRect bounds);
+
+#ifdef PROFILE
+// Counters since the last report, times in ticks of the profile clock
+typedef struct {
+    const char *name;
+    uint16_t draws;
+    uint16_t fills;
+    uint16_t max_ms;
+    uint32_t total_ms;
+} FctxLayerProfile;
+
+typedef uint32_t (*FctxLayerProfileClock)(void);
+typedef void (*FctxLayerProfileHandler)(const FctxLayerProfile *profile, void *context);
+
+void fctx_layer_set_name(FctxLayer *this, const char *name);
+void fctx_layer_profile_fill(void);
+void fctx_layer_profile_set_clock(FctxLayerProfileClock clock);
+void fctx_layer_profile_collect(FctxLayerProfileHandler handler, void *context);
+void fctx_layer_profile_report(FctxLayer *this);
+#else
+#define fctx_layer_set_name(this, name)
+#define fctx_layer_profile_fill()
+#define fctx_layer_profile_set_clock(clock)
+#define fctx_layer_profile_collect(handler, context)
+#define fctx_layer_profile_report(this)
+#endif
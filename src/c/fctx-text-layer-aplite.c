@@ -9,6 +9,12 @@ struct FctxTextLayer {
     TextLayer *text_layer;
 };
 
+// what fctx_layer_pool_init needs to fit a text layer
+size_t fctx_text_layer_data_size(void) {
+    logf();
+    return sizeof(FctxTextLayer);
+}
+
 FctxTextLayer *fctx_text_layer_create(const GRect frame) {
     logf();
     FctxLayer *layer = fctx_layer_create_with_data(GRect(0, 0, PBL_DISPLAY_WIDTH, PBL_DISPLAY_HEIGHT), sizeof(FctxTextLayer));
@@ -30,7 +36,7 @@ void fctx_text_layer_destroy(FctxTextLayer *this) {
 }
 
 FctxLayer *fctx_text_layer_get_fctx_layer(const FctxTextLayer *this) {
-    logf();
+    logg();
     return this->layer;
 }
 
@@ -40,7 +46,7 @@ void fctx_text_layer_set_text(FctxTextLayer *this, const char *text) {
 }
 
 const char *fctx_text_layer_get_text(const FctxTextLayer *this) {
-    logf();
+    logg();
     return text_layer_get_text(this->text_layer);
 }
 
@@ -74,4 +80,9 @@ void fctx_text_layer_set_anchor(FctxTextLayer *this, FTextAnchor anchor) {
     logf();
     // no-op
 }
+
+void fctx_text_layer_set_glyph_atlas(FctxTextLayer *this, const char *glyphs, GColor background) {
+    logf();
+    // no-op
+}
 #endif
@@ -3,44 +3,141 @@
 #include <pebble-fctx/ffont.h>
 #include "fctx-layer.h"
 #include "fctx-text-layer.h"
+#include "ffont-cache.h"
+#include "glyph-atlas.h"
 #include "logging.h"
+#include "widgets.h"
 
 struct FctxTextLayer {
     FctxLayer *layer;
     const char *text;
     uint32_t font;
+    FFont *ffont;
     GColor color;
     int16_t text_size;
     GTextAlignment alignment;
     FTextAnchor anchor;
+    GlyphAtlas *atlas;
+    struct {
+        // the text the size was fitted to; longer texts are fitted every time
+        char text[WIDGET_BUF_LEN];
+        int16_t width;
+        uint32_t font;
+        int16_t text_size;
+        int16_t font_size;
+    } fit;
 };
 
+static int16_t prv_fit_font_size(FctxTextLayer *this, FContext *fctx, FFont *font, int16_t width) {
+    if (this->fit.font_size > 0 && strcmp(this->fit.text, this->text) == 0 && this->fit.width == width &&
+            this->fit.font == this->font && this->fit.text_size == this->text_size) {
+        return this->fit.font_size;
+    }
+
+    fixed_t max_width = INT_TO_FIXED(width);
+    int16_t lo = 1;
+    int16_t hi = this->text_size;
+
+    fctx_set_text_em_height(fctx, font, hi);
+    if (fctx_string_width(fctx, this->text, font) > max_width) {
+        // largest size in [lo, hi) that fits; lo is accepted even if it overflows
+        hi--;
+        while (lo < hi) {
+            int16_t mid = lo + (hi - lo + 1) / 2;
+            fctx_set_text_em_height(fctx, font, mid);
+            if (fctx_string_width(fctx, this->text, font) > max_width) hi = mid - 1;
+            else lo = mid;
+        }
+    } else {
+        lo = hi;
+    }
+
+    size_t length = strlen(this->text);
+    if (length >= sizeof(this->fit.text)) {
+        this->fit.font_size = 0;
+        return lo;
+    }
+    memcpy(this->fit.text, this->text, length + 1);
+    this->fit.width = width;
+    this->fit.font = this->font;
+    this->fit.text_size = this->text_size;
+    this->fit.font_size = lo;
+    return lo;
+}
+
 static void prv_update_proc(FctxLayer *layer, FContext *fctx) {
     logf();
     FctxTextLayer *this = fctx_layer_get_data(layer);
     if (!this->text || this->text_size <= 0 || gcolor_equal(this->color, GColorClear)) return;
 
     GRect frame = fctx_layer_get_frame(layer);
-    FFont *font = ffont_create_from_resource(this->font);
+    FFont *font = this->ffont;
     if (!font) return;
 
-    int16_t font_size = this->text_size;
-    fixed_t str_width;
-    fixed_t width = INT_TO_FIXED(frame.size.w);
-
-    do {
-        fctx_set_text_em_height(fctx, font, font_size--);
-        str_width = fctx_string_width(fctx, this->text, font);
-    } while (str_width > width);
+    int16_t font_size = prv_fit_font_size(this, fctx, font, frame.size.w);
+    if (this->atlas && glyph_atlas_draw(this->atlas, fctx, font, font_size, this->color, this->text,
+                                        fctx_layer_get_draw_origin(layer), this->alignment, this->anchor)) {
+        return;
+    }
 
-    fctx_set_text_em_height(fctx, font, ++font_size);
+    fctx_set_text_em_height(fctx, font, font_size);
     fctx_set_fill_color(fctx, this->color);
 
     fctx_begin_fill(fctx);
     fctx_draw_string(fctx, this->text, font, this->alignment, this->anchor);
     fctx_end_fill(fctx);
+    fctx_layer_profile_fill();
+}
 
-    ffont_destroy(font);
+// font units to pixels at the layer's text size, rounded outwards
+static int16_t prv_px_floor(const FctxTextLayer *this, int32_t units) {
+    int32_t upem = this->ffont->units_per_em;
+    int32_t scaled = units * this->text_size;
+    return scaled >= 0 ? scaled / upem : -((-scaled + upem - 1) / upem);
+}
+
+static int16_t prv_px_ceil(const FctxTextLayer *this, int32_t units) {
+    return -prv_px_floor(this, -units);
+}
+
+// The box any text fitted to the frame can ink: the font's glyph extents at the
+// full text size, placed by the anchor and spread over the frame width
+static void prv_update_damage(FctxTextLayer *this) {
+    FFontExtents extents;
+    if (!this->ffont || this->text_size <= 0 || !ffont_cache_get_extents(this->font, &extents)) {
+        fctx_layer_set_damage(this->layer, GRectZero);
+        return;
+    }
+    FFont *font = this->ffont;
+    GRect frame = fctx_layer_get_frame(this->layer);
+    int16_t w = frame.size.w;
+
+    int16_t x = 0;
+    if (this->alignment == GTextAlignmentCenter) x = -w / 2;
+    else if (this->alignment == GTextAlignmentRight) x = -w;
+
+    // where the baseline sits below the anchor, in font units
+    int32_t baseline = 0;
+    switch (this->anchor) {
+        case FTextAnchorBaseline: break;
+        case FTextAnchorMiddle: baseline = (font->ascent + font->descent) / 2; break;
+        case FTextAnchorTop: baseline = font->ascent; break;
+        case FTextAnchorBottom: baseline = font->descent; break;
+        case FTextAnchorCapMiddle: baseline = font->cap_height / 2; break;
+        case FTextAnchorCapTop: baseline = font->cap_height; break;
+    }
+
+    int16_t x1 = x + prv_px_floor(this, extents.x_min);
+    int16_t x2 = x + w + prv_px_ceil(this, extents.x_over);
+    int16_t y1 = prv_px_floor(this, baseline - extents.y_max);
+    int16_t y2 = prv_px_ceil(this, baseline - extents.y_min);
+    fctx_layer_set_damage(this->layer, GRect(x1, y1, x2 - x1, y2 - y1));
+}
+
+// what fctx_layer_pool_init needs to fit a text layer
+size_t fctx_text_layer_data_size(void) {
+    logf();
+    return sizeof(FctxTextLayer);
 }
 
 FctxTextLayer *fctx_text_layer_create(const GRect frame) {
@@ -51,20 +148,28 @@ FctxTextLayer *fctx_text_layer_create(const GRect frame) {
     this->layer = layer;
     this->text = NULL;
     this->font = 0;
+    this->ffont = NULL;
     this->color = GColorClear;
     this->text_size = 0;
     this->alignment = GTextAlignmentLeft;
     this->anchor = FTextAnchorTop;
+    this->atlas = NULL;
+    this->fit.font_size = 0;
+    prv_update_damage(this);
     return this;
 }
 
 void fctx_text_layer_destroy(FctxTextLayer *this) {
     logf();
+    if (this->ffont) ffont_cache_release(this->font);
+    this->ffont = NULL;
+    if (this->atlas) glyph_atlas_destroy(this->atlas);
+    this->atlas = NULL;
     fctx_layer_destroy(this->layer);
 }
 
 FctxLayer *fctx_text_layer_get_fctx_layer(const FctxTextLayer *this) {
-    logf();
+    logg();
     return this->layer;
 }
 
@@ -75,13 +180,17 @@ void fctx_text_layer_set_text(FctxTextLayer *this, const char *text) {
 }
 
 const char *fctx_text_layer_get_text(const FctxTextLayer *this) {
-    logf();
+    logg();
     return this->text;
 }
 
 void fctx_text_layer_set_font(FctxTextLayer *this, uint32_t font) {
     logf();
+    if (this->ffont && this->font == font) return;
+    if (this->ffont) ffont_cache_release(this->font);
     this->font = font;
+    this->ffont = ffont_cache_acquire(font);
+    prv_update_damage(this);
     fctx_layer_mark_dirty(this->layer);
 }
 
@@ -94,18 +203,33 @@ void fctx_text_layer_set_color(FctxTextLayer *this, GColor color) {
 void fctx_text_layer_set_text_size(FctxTextLayer *this, int16_t text_size) {
     logf();
     this->text_size = text_size;
+    prv_update_damage(this);
     fctx_layer_mark_dirty(this->layer);
 }
 
 void fctx_text_layer_set_alignment(FctxTextLayer *this, GTextAlignment alignment) {
     logf();
     this->alignment = alignment;
+    prv_update_damage(this);
     fctx_layer_mark_dirty(this->layer);
 }
 
 void fctx_text_layer_set_anchor(FctxTextLayer *this, FTextAnchor anchor) {
     logf();
     this->anchor = anchor;
+    prv_update_damage(this);
+    fctx_layer_mark_dirty(this->layer);
+}
+
+void fctx_text_layer_set_glyph_atlas(FctxTextLayer *this, const char *glyphs, GColor background) {
+    logf();
+    if (this->atlas && !glyphs) {
+        glyph_atlas_destroy(this->atlas);
+        this->atlas = NULL;
+    } else if (glyphs) {
+        if (!this->atlas) this->atlas = glyph_atlas_create(glyphs);
+        if (this->atlas) glyph_atlas_set_background_color(this->atlas, background);
+    }
     fctx_layer_mark_dirty(this->layer);
 }
 #endif
@@ -3,6 +3,7 @@
 
 typedef struct FctxTextLayer FctxTextLayer;
 
+size_t fctx_text_layer_data_size(void);
 FctxTextLayer *fctx_text_layer_create(const GRect frame);
 void fctx_text_layer_destroy(FctxTextLayer *this);
 FctxLayer *fctx_text_layer_get_fctx_layer(const FctxTextLayer *this);
@@ -13,3 +14,4 @@ void fctx_text_layer_set_color(FctxTextLayer *this, GColor color);
 void fctx_text_layer_set_text_size(FctxTextLayer *this, int16_t pixels);
 void fctx_text_layer_set_alignment(FctxTextLayer *this, GTextAlignment alignment);
 void fctx_text_layer_set_anchor(FctxTextLayer *this, FTextAnchor anchor);
+void fctx_text_layer_set_glyph_atlas(FctxTextLayer *this, const char *glyphs, GColor background);
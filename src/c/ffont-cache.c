@@ -0,0 +1,132 @@
+#ifndef PBL_PLATFORM_APLITE
+#include <pebble.h>
+#include <pebble-fctx/ffont.h>
+#include "ffont-cache.h"
+#include "heap-account.h"
+#include "logging.h"
+
+#define FFONT_CACHE_SIZE 2
+
+typedef struct {
+    uint32_t resource_id;
+    FFont *font;
+    FFontExtents extents;
+    uint16_t ref_count;
+} FFontCacheEntry;
+
+static FFontCacheEntry s_entries[FFONT_CACHE_SIZE];
+#ifdef DEBUG
+static uint32_t s_load_count;
+#endif
+
+static FFontCacheEntry *prv_find(uint32_t resource_id) {
+    for (uint i = 0; i < ARRAY_LENGTH(s_entries); i++) {
+        if (s_entries[i].ref_count > 0 && s_entries[i].resource_id == resource_id) return &s_entries[i];
+    }
+    return NULL;
+}
+
+static void prv_extend(FFontExtents *extents, fixed16_t x, fixed16_t y, fixed16_t advance) {
+    if (x < extents->x_min) extents->x_min = x;
+    if (x - advance > extents->x_over) extents->x_over = x - advance;
+    if (y < extents->y_min) extents->y_min = y;
+    if (y > extents->y_max) extents->y_max = y;
+}
+
+// Walks every outline once, counting the control points of curves as ink since
+// the curve never leaves their hull
+static void prv_measure(FFont *font, FFontExtents *extents) {
+    memset(extents, 0, sizeof(FFontExtents));
+    for (uint16_t i = 0; i < font->glyph_table_length; i++) {
+        FGlyph *glyph = &font->glyph_table[i];
+        fixed16_t *data = ffont_glyph_outline(font, glyph);
+        fixed16_t *end = (fixed16_t *) ((uint8_t *) data + glyph->path_data_length);
+        fixed16_t x = 0;
+        fixed16_t y = 0;
+        while (data < end) {
+            uint8_t args;
+            switch (*data++) {
+                case 'M': case 'L': case 'T': args = 2; break;
+                case 'H': case 'V': args = 1; break;
+                case 'Q': case 'S': args = 4; break;
+                case 'C': args = 6; break;
+                case 'Z': args = 0; break;
+                default: args = 0xff; break;
+            }
+            if (args == 0xff || data + args > end) break;
+            if (args == 1) {
+                if (data[-1] == 'H') x = data[0];
+                else y = data[0];
+                prv_extend(extents, x, y, glyph->horiz_adv_x);
+            }
+            for (uint8_t j = 0; args > 1 && j < args; j += 2) {
+                x = data[j];
+                y = data[j + 1];
+                prv_extend(extents, x, y, glyph->horiz_adv_x);
+            }
+            data += args;
+        }
+    }
+}
+
+FFont *ffont_cache_acquire(uint32_t resource_id) {
+    logf();
+    FFontCacheEntry *entry = prv_find(resource_id);
+    if (entry) {
+        entry->ref_count++;
+        return entry->font;
+    }
+
+    for (uint i = 0; i < ARRAY_LENGTH(s_entries); i++) {
+        if (s_entries[i].ref_count > 0) continue;
+
+        heap_account_begin(HeapSubsystemFonts);
+        FFont *font = ffont_create_from_resource(resource_id);
+        heap_account_end();
+        if (!font) {
+            loge("failed to load font %ld", resource_id);
+            return NULL;
+        }
+        s_entries[i].resource_id = resource_id;
+        s_entries[i].font = font;
+        s_entries[i].ref_count = 1;
+        prv_measure(font, &s_entries[i].extents);
+#ifdef DEBUG
+        s_load_count++;
+#endif
+        return font;
+    }
+
+    loge("font cache full");
+    return NULL;
+}
+
+void ffont_cache_release(uint32_t resource_id) {
+    logf();
+    FFontCacheEntry *entry = prv_find(resource_id);
+    if (!entry) return;
+
+    if (--entry->ref_count == 0) {
+        heap_account_begin(HeapSubsystemFonts);
+        ffont_destroy(entry->font);
+        heap_account_end();
+        entry->font = NULL;
+    }
+}
+
+bool ffont_cache_get_extents(uint32_t resource_id, FFontExtents *extents) {
+    logf();
+    FFontCacheEntry *entry = prv_find(resource_id);
+    if (!entry) return false;
+    *extents = entry->extents;
+    return true;
+}
+
+#ifdef DEBUG
+// Fonts loaded from resources since launch, so callers can check that drawing loads none
+uint32_t ffont_cache_load_count(void) {
+    logf();
+    return s_load_count;
+}
+#endif
+#endif
@@ -0,0 +1,19 @@
+#pragma once
+#include <pebble.h>
+#include <pebble-fctx/ffont.h>
+
+// Where any glyph's ink can reach, in font units: x_min left of the pen position and
+// x_over past the glyph's advance, y_min and y_max about the baseline, y up
+typedef struct {
+    fixed16_t x_min;
+    fixed16_t x_over;
+    fixed16_t y_min;
+    fixed16_t y_max;
+} FFontExtents;
+
+FFont *ffont_cache_acquire(uint32_t resource_id);
+bool ffont_cache_get_extents(uint32_t resource_id, FFontExtents *extents);
+void ffont_cache_release(uint32_t resource_id);
+#ifdef DEBUG
+uint32_t ffont_cache_load_count(void);
+#endif
@@ -2,92 +2,134 @@
 #include <pebble.h>
 #include <pebble-events/pebble-events.h>
 #include <pebble-geocode-mapquest/pebble-geocode-mapquest.h>
-#include <@smallstoneapps/linked-list/linked-list.h>
 #include "logging.h"
 #include "geocode.h"
-
-static const uint32_t PERSIST_KEY_GEOCODE_COORDINATES = 4;
+#include "event-bus.h"
+#include "heap-account.h"
+#include "persist-store.h"
 
 #ifndef GEOCODE_API_KEY
 #pragma message("GEOCODE_API_KEY not defined")
 #define GEOCODE_API_KEY ""
 #endif
 
-typedef struct {
-    EventGeocodeHandler handler;
-    void *context;
-} GeocodeHandlerState;
-
-typedef struct {
-    GeocodeMapquestCoordinates *coordinates;
-    GeocodeMapquestStatus status;
-} GeocodeBundle;
-
-static LinkedRoot *s_handler_list;
+// seconds after which a lookup that never got a reply no longer holds up the next one
+#define GEOCODE_FETCH_TIMEOUT 60
+
+static EventBus s_handler_bus;
+static GeocodeMapquestCoordinates s_coordinates;
+// the lookup in flight, 0 if none. Replies don't say which name they are for, so
+// there is only ever one, and the latest name asked for meanwhile waits for it.
+static uint32_t s_fetch_hash;
+static time_t s_fetch_time;
+static char s_queued[GEOCODE_MAPQUEST_MAX_LOCATION_LEN];
+
+// djb2 over the name lowercased, trimmed and with runs of whitespace collapsed,
+// the same normalization src/pkjs/index.js uses for its cache
+static uint32_t normalized_hash(const char *name) {
+    uint32_t hash = 5381;
+    bool space = false;
+    bool empty = true;
+    for (const char *c = name; *c; c++) {
+        if (*c == ' ' || *c == '\t' || *c == '\n') {
+            space = !empty;
+            continue;
+        }
+        if (space) hash = hash * 33 + ' ';
+        space = false;
+        empty = false;
+        char lower = (*c >= 'A' && *c <= 'Z') ? *c - 'A' + 'a' : *c;
+        hash = hash * 33 + (uint8_t) lower;
+    }
+    return empty ? 0 : hash;
+}
 
-static bool each_geocode_fetched(void *this, void *context) {
+static void notify_handlers(GeocodeMapquestCoordinates *coordinates, GeocodeMapquestStatus status) {
     logf();
-    GeocodeHandlerState *state = (GeocodeHandlerState *) this;
-    GeocodeBundle *bundle = (GeocodeBundle *) context;
-    state->handler(bundle->coordinates, bundle->status, state->context);
-    return true;
+    for (uint i = 0; i < EVENT_BUS_CAPACITY; i++) {
+        EventBusSlot *slot = &s_handler_bus.slots[i];
+        if (slot->handler) ((EventGeocodeHandler) slot->handler)(coordinates, status, slot->context);
+    }
 }
 
 static void geocode_fetch_callback(GeocodeMapquestCoordinates *coordinates, GeocodeMapquestStatus status) {
     logf();
-    GeocodeBundle bundle = {
-        .coordinates = coordinates,
-        .status = status
-    };
-    linked_list_foreach(s_handler_list, each_geocode_fetched, &bundle);
+    if (status == GeocodeMapquestStatusPending) {
+        notify_handlers(coordinates, status);
+        return;
+    }
+
+    if (status == GeocodeMapquestStatusAvailable) {
+        persist_store_set_coordinates(coordinates);
+        persist_store_set_place(s_fetch_hash, coordinates);
+        persist_store_flush();
+    }
+    s_fetch_hash = 0;
+
+    // the place is kept either way, but the location it was for has been changed since
+    if (s_queued[0]) {
+        char location[sizeof(s_queued)];
+        strncpy(location, s_queued, sizeof(location));
+        s_queued[0] = '\0';
+        geocode_fetch(location);
+        return;
+    }
+    notify_handlers(coordinates, status);
 }
 
 void geocode_init(void) {
     logf();
-    s_handler_list = linked_list_create_root();
+    event_bus_init(&s_handler_bus);
     geocode_mapquest_init();
     geocode_mapquest_set_api_key(GEOCODE_API_KEY);
-
-    geocode_mapquest_load(PERSIST_KEY_GEOCODE_COORDINATES);
 }
 
 void geocode_fetch(const char *location) {
     logf();
+    if (s_fetch_hash && time(NULL) - s_fetch_time < GEOCODE_FETCH_TIMEOUT) {
+        strncpy(s_queued, location, sizeof(s_queued) - 1);
+        s_queued[sizeof(s_queued) - 1] = '\0';
+        return;
+    }
+    s_queued[0] = '\0';
+
+    // a hit is already stored, as the place and the coordinates it was fetched with
+    uint32_t hash = normalized_hash(location);
+    if (persist_store_get_place(hash, &s_coordinates)) {
+        logd("geocode cache hit");
+        s_fetch_hash = 0;
+        notify_handlers(&s_coordinates, GeocodeMapquestStatusAvailable);
+        return;
+    }
+
+    s_fetch_hash = hash;
+    s_fetch_time = time(NULL);
+    heap_account_begin(HeapSubsystemGeocode);
     geocode_mapquest_fetch(location, geocode_fetch_callback);
+    heap_account_end();
 }
 
 void geocode_deinit(void) {
     logf();
-    geocode_mapquest_save(PERSIST_KEY_GEOCODE_COORDINATES);
     geocode_mapquest_deinit();
-
-    free(s_handler_list);
 }
 
-GeocodeMapquestCoordinates *geocode_peek(void) {
+// The cached place for the location, or else the last coordinates fetched, which is
+// all releases before the place cache kept
+GeocodeMapquestCoordinates *geocode_peek(const char *location) {
     logf();
+    if (persist_store_get_place(normalized_hash(location), &s_coordinates)) return &s_coordinates;
+    if (persist_store_get_coordinates(&s_coordinates)) return &s_coordinates;
     return geocode_mapquest_peek();
 }
 
 EventHandle events_geocode_subscribe(EventGeocodeHandler handler, void *context) {
     logf();
-    GeocodeHandlerState *this = malloc(sizeof(GeocodeHandlerState));
-    this->handler = handler;
-    this->context = context;
-    linked_list_append(s_handler_list, this);
-
-    return this;
+    return event_bus_subscribe(&s_handler_bus, (EventBusHandler) handler, context);
 }
 
 void events_geocode_unsubscribe(EventHandle handle) {
     logf();
-
-    int16_t index = linked_list_find(s_handler_list, handle);
-    if (index == -1) {
-        return;
-    }
-
-    free(linked_list_get(s_handler_list, index));
-    linked_list_remove(s_handler_list, index);
+    event_bus_unsubscribe(&s_handler_bus, handle);
 }
 #endif
@@ -8,7 +8,7 @@ typedef void(*EventGeocodeHandler)(GeocodeMapquestCoordinates *coordinates, Geoc
 void geocode_init(void);
 void geocode_deinit(void);
 void geocode_fetch(const char *location);
-GeocodeMapquestCoordinates *geocode_peek(void);
+GeocodeMapquestCoordinates *geocode_peek(const char *location);
 
 EventHandle events_geocode_subscribe(EventGeocodeHandler handler, void *context);
 void events_geocode_unsubscribe(EventHandle handle);
@@ -0,0 +1,247 @@
+#ifndef PBL_PLATFORM_APLITE
+#include <pebble.h>
+#include <pebble-fctx/fctx.h>
+#include <pebble-fctx/ffont.h>
+#include "glyph-atlas.h"
+#include "fb-capture.h"
+#include "fctx-layer.h"
+#include "logging.h"
+
+#define GLYPH_ATLAS_MAX_GLYPHS 16
+#define GLYPH_ATLAS_MAX_COLORS 16
+
+// Glyphs are rasterized once over the background into an offscreen cell and the
+// pixels fctx produced are kept as they are, in a palette of the colours that
+// occur. Cells are blitted opaque and tile exactly, each as wide as the whole
+// pixels its advance spans, so the glyphs' ink must stay inside their advance
+// and above the descent, over a solid background.
+struct GlyphAtlas {
+    char glyphs[GLYPH_ATLAS_MAX_GLYPHS + 1];
+    uint8_t count;
+    int16_t width;
+    GBitmap *bitmap;
+    int16_t x[GLYPH_ATLAS_MAX_GLYPHS];
+    fixed_t advance[GLYPH_ATLAS_MAX_GLYPHS];
+    FFont *font;
+    int16_t font_size;
+    FTextAnchor anchor;
+    GColor color;
+    GColor background;
+};
+
+// palette of the colours seen so far, in the order they were first seen
+typedef struct {
+    GColor colors[GLYPH_ATLAS_MAX_COLORS];
+    uint8_t count;
+} GlyphAtlasPalette;
+
+static int16_t prv_cell_top(FTextAnchor anchor, int16_t font_size) {
+    if (anchor == FTextAnchorBottom || anchor == FTextAnchorBaseline) return -font_size;
+    if (anchor == FTextAnchorMiddle) return -font_size / 2;
+    return 0;
+}
+
+static int16_t prv_cell_width(fixed_t advance) {
+    return FIXED_TO_INT(advance + INT_TO_FIXED(1) - 1);
+}
+
+static int8_t prv_index_of(const GlyphAtlas *this, char c) {
+    for (uint8_t i = 0; i < this->count; i++) {
+        if (this->glyphs[i] == c) return i;
+    }
+    return -1;
+}
+
+static int8_t prv_palette_index(GlyphAtlasPalette *palette, GColor color) {
+    for (uint8_t i = 0; i < palette->count; i++) {
+        if (gcolor_equal(palette->colors[i], color)) return i;
+    }
+    if (palette->count == GLYPH_ATLAS_MAX_COLORS) return -1;
+    palette->colors[palette->count] = color;
+    return palette->count++;
+}
+
+// 1-bit frame buffers (diorite) hold eight pixels per byte, least significant bit first
+static GColor prv_pixel(const GBitmap *cell, int16_t x, int16_t y) {
+    const uint8_t *row = gbitmap_get_data(cell) + y * gbitmap_get_bytes_per_row(cell);
+    if (gbitmap_get_format(cell) == GBitmapFormat1Bit) return ((row[x / 8] >> (x % 8)) & 1) ? GColorWhite : GColorBlack;
+    return (GColor) { .argb = row[x] };
+}
+
+// Palettized bitmaps hold their pixels most significant bits first
+static void prv_set_index(GBitmap *bitmap, uint8_t bits, int16_t x, int16_t y, uint8_t index) {
+    uint8_t *row = gbitmap_get_data(bitmap) + y * gbitmap_get_bytes_per_row(bitmap);
+    uint8_t per_byte = 8 / bits;
+    uint8_t shift = (per_byte - 1 - x % per_byte) * bits;
+    uint8_t mask = ((1 << bits) - 1) << shift;
+    row[x / per_byte] = (row[x / per_byte] & ~mask) | (index << shift);
+}
+
+// Draws glyph i over the background into cell, which takes the place of the frame buffer meanwhile
+static bool prv_rasterize(GlyphAtlas *this, FContext *fctx, GBitmap *cell, uint8_t i) {
+    FbRedirect saved;
+    if (!fb_redirect_begin(fctx->gctx, cell, &saved)) return false;
+    char glyph[2] = { this->glyphs[i], 0 };
+    GRect bounds = gbitmap_get_bounds(cell);
+
+    fctx_set_offset(fctx, FPointZero);
+    fctx_set_scale(fctx, FPointOne, FPointOne);
+    fctx_set_fill_color(fctx, this->background);
+    fctx_begin_fill(fctx);
+    fctx_move_to(fctx, FPointI(0, 0));
+    fctx_line_to(fctx, FPointI(bounds.size.w, 0));
+    fctx_line_to(fctx, FPointI(bounds.size.w, bounds.size.h));
+    fctx_line_to(fctx, FPointI(0, bounds.size.h));
+    fctx_close_path(fctx);
+    fctx_end_fill(fctx);
+
+    fctx_set_text_em_height(fctx, this->font, this->font_size);
+    fctx_set_offset(fctx, FPointI(0, -prv_cell_top(this->anchor, this->font_size)));
+    fctx_set_fill_color(fctx, this->color);
+    fctx_begin_fill(fctx);
+    fctx_draw_string(fctx, glyph, this->font, GTextAlignmentLeft, this->anchor);
+    fctx_end_fill(fctx);
+    fctx_layer_profile_fill();
+
+    fb_redirect_end(fctx->gctx, &saved);
+    return true;
+}
+
+// Rasterizes every glyph twice: once to learn the colours fctx produces, which
+// sets the depth of the atlas, and once to fill it in
+static bool prv_build(GlyphAtlas *this, FContext *fctx, FFont *font, int16_t font_size, GColor color, FTextAnchor anchor) {
+    logf();
+    if (this->bitmap) gbitmap_destroy(this->bitmap);
+    this->bitmap = NULL;
+
+    this->font = font;
+    this->font_size = font_size;
+    this->anchor = anchor;
+    this->color = color;
+
+    fctx_set_text_em_height(fctx, font, font_size);
+    char glyph[2] = { 0, 0 };
+    int16_t width = 0;
+    int16_t cell_width = 0;
+    for (uint8_t i = 0; i < this->count; i++) {
+        glyph[0] = this->glyphs[i];
+        this->advance[i] = fctx_string_width(fctx, glyph, font);
+        this->x[i] = width;
+        width += prv_cell_width(this->advance[i]);
+        if (prv_cell_width(this->advance[i]) > cell_width) cell_width = prv_cell_width(this->advance[i]);
+    }
+    this->width = width;
+
+    GBitmap *cell = gbitmap_create_blank(GSize(cell_width, font_size), PBL_IF_COLOR_ELSE(GBitmapFormat8Bit, GBitmapFormat1Bit));
+    if (!cell) {
+        loge("failed to allocate glyph cell");
+        return false;
+    }
+
+    GlyphAtlasPalette palette = { .count = 0 };
+    bool fits = true;
+    for (uint8_t i = 0; i < this->count && fits; i++) {
+        fits = prv_rasterize(this, fctx, cell, i);
+        int16_t w = prv_cell_width(this->advance[i]);
+        for (int16_t y = 0; y < font_size && fits; y++) {
+            for (int16_t x = 0; x < w && fits; x++) fits = prv_palette_index(&palette, prv_pixel(cell, x, y)) >= 0;
+        }
+    }
+
+    uint8_t bits = palette.count <= 2 ? 1 : palette.count <= 4 ? 2 : 4;
+    GBitmapFormat format = bits == 1 ? GBitmapFormat1BitPalette : bits == 2 ? GBitmapFormat2BitPalette : GBitmapFormat4BitPalette;
+    GColor *colors = fits ? malloc(sizeof(GColor) << bits) : NULL;
+    if (colors) {
+        memcpy(colors, palette.colors, sizeof(GColor) * palette.count);
+        this->bitmap = gbitmap_create_blank_with_palette(GSize(width, font_size), format, colors, true);
+        if (!this->bitmap) free(colors);
+    }
+    if (!this->bitmap) {
+        if (fits) loge("failed to allocate glyph atlas");
+        gbitmap_destroy(cell);
+        return false;
+    }
+
+    for (uint8_t i = 0; i < this->count; i++) {
+        if (!prv_rasterize(this, fctx, cell, i)) break;
+        int16_t w = prv_cell_width(this->advance[i]);
+        for (int16_t y = 0; y < font_size; y++) {
+            for (int16_t x = 0; x < w; x++) {
+                prv_set_index(this->bitmap, bits, this->x[i] + x, y, prv_palette_index(&palette, prv_pixel(cell, x, y)));
+            }
+        }
+    }
+    gbitmap_destroy(cell);
+    return true;
+}
+
+GlyphAtlas *glyph_atlas_create(const char *glyphs) {
+    logf();
+    GlyphAtlas *this = malloc(sizeof(GlyphAtlas));
+    if (!this) {
+        loge("failed to allocate glyph atlas");
+        return NULL;
+    }
+    strncpy(this->glyphs, glyphs, GLYPH_ATLAS_MAX_GLYPHS);
+    this->glyphs[GLYPH_ATLAS_MAX_GLYPHS] = '\0';
+    this->count = strlen(this->glyphs);
+    this->width = 0;
+    this->bitmap = NULL;
+    this->font = NULL;
+    this->font_size = 0;
+    this->anchor = FTextAnchorTop;
+    this->color = GColorClear;
+    this->background = GColorBlack;
+    return this;
+}
+
+void glyph_atlas_destroy(GlyphAtlas *this) {
+    logf();
+    if (this->bitmap) gbitmap_destroy(this->bitmap);
+    free(this);
+}
+
+void glyph_atlas_set_background_color(GlyphAtlas *this, GColor background) {
+    logf();
+    if (gcolor_equal(this->background, background)) return;
+    this->background = background;
+    if (this->bitmap) gbitmap_destroy(this->bitmap);
+    this->bitmap = NULL;
+}
+
+bool glyph_atlas_draw(GlyphAtlas *this, FContext *fctx, FFont *font, int16_t font_size, GColor color,
+                      const char *text, GPoint origin, GTextAlignment alignment, FTextAnchor anchor) {
+    logf();
+    fixed_t width = 0;
+    if (this->count == 0) return false;
+    for (const char *c = text; *c; c++) {
+        if (prv_index_of(this, *c) < 0) return false;
+    }
+
+    if (!this->bitmap || this->font != font || this->font_size != font_size || this->anchor != anchor ||
+            !gcolor_equal(this->color, color)) {
+        if (!prv_build(this, fctx, font, font_size, color, anchor)) return false;
+    }
+
+    for (const char *c = text; *c; c++) width += this->advance[prv_index_of(this, *c)];
+
+    fixed_t x = INT_TO_FIXED(origin.x);
+    if (alignment == GTextAlignmentCenter) x -= width / 2;
+    else if (alignment == GTextAlignmentRight) x -= width;
+    int16_t y = origin.y + prv_cell_top(anchor, font_size);
+
+    // each cell covers the pixels from where its advance starts to where the next one's does
+    GContext *ctx = fctx->gctx;
+    for (const char *c = text; *c; c++) {
+        int8_t i = prv_index_of(this, *c);
+        int16_t x0 = FIXED_TO_INT(x);
+        x += this->advance[i];
+        GRect cell = GRect(this->x[i], 0, FIXED_TO_INT(x) - x0, font_size);
+        gbitmap_set_bounds(this->bitmap, cell);
+        graphics_draw_bitmap_in_rect(ctx, this->bitmap, GRect(x0, y, cell.size.w, cell.size.h));
+    }
+    gbitmap_set_bounds(this->bitmap, GRect(0, 0, this->width, font_size));
+
+    return true;
+}
+#endif
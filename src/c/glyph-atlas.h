@@ -0,0 +1,12 @@
+#pragma once
+#include <pebble.h>
+#include <pebble-fctx/fctx.h>
+#include <pebble-fctx/ffont.h>
+
+typedef struct GlyphAtlas GlyphAtlas;
+
+GlyphAtlas *glyph_atlas_create(const char *glyphs);
+void glyph_atlas_destroy(GlyphAtlas *this);
+void glyph_atlas_set_background_color(GlyphAtlas *this, GColor background);
+bool glyph_atlas_draw(GlyphAtlas *this, FContext *fctx, FFont *font, int16_t font_size, GColor color,
+                      const char *text, GPoint origin, GTextAlignment alignment, FTextAnchor anchor);
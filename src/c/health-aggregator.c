@@ -0,0 +1,151 @@
+#ifdef PBL_HEALTH
+#include <pebble.h>
+#include <pebble-events/pebble-events.h>
+#include "health-aggregator.h"
+#include "logging.h"
+
+#define HEALTH_AGGREGATOR_MOVEMENT (HealthAggregatorMetricSteps | HealthAggregatorMetricDistance | HealthAggregatorMetricActiveSeconds)
+
+typedef struct {
+    HealthMetric metric;
+    bool current;
+    HealthValue value;
+} HealthAggregatorEntry;
+
+static HealthAggregatorEntry s_entries[] = {
+    { HealthMetricStepCount, false, 0 },
+    { HealthMetricWalkedDistanceMeters, false, 0 },
+    { HealthMetricActiveSeconds, false, 0 },
+#ifdef PBL_PLATFORM_DIORITE
+    { HealthMetricHeartRateBPM, true, 0 },
+#endif
+};
+
+static HealthAggregatorHandler s_handler;
+static void *s_context;
+static EventHandle s_health_event_handle;
+static AppTimer *s_timer;
+
+static uint8_t s_metrics;
+static uint8_t s_available;
+static uint8_t s_checked;
+static time_t s_checked_day;
+static time_t s_last_movement;
+// movement updates closer together than this many seconds are deferred
+static uint16_t s_min_interval = 60;
+
+static bool prv_accessible(uint8_t i) {
+    time_t today = time_start_of_today();
+    if (today != s_checked_day) {
+        s_checked_day = today;
+        s_checked = 0;
+        s_available = 0;
+    }
+
+    uint8_t bit = 1 << i;
+    if (!(s_checked & bit)) {
+        time_t now = time(NULL);
+        HealthServiceAccessibilityMask mask = health_service_metric_accessible(s_entries[i].metric, s_entries[i].current ? now : today, now);
+        s_checked |= bit;
+        if (mask & HealthServiceAccessibilityMaskAvailable) s_available |= bit;
+    }
+    return s_available & bit;
+}
+
+static void prv_refresh(uint8_t metrics) {
+    logf();
+    uint8_t changed = 0;
+    for (uint8_t i = 0; i < ARRAY_LENGTH(s_entries); i++) {
+        uint8_t bit = 1 << i;
+        if (!(metrics & s_metrics & bit) || !prv_accessible(i)) continue;
+
+        HealthAggregatorEntry *entry = &s_entries[i];
+        HealthValue value = entry->current ? health_service_peek_current_value(entry->metric) : health_service_sum_today(entry->metric);
+        if (value != entry->value) {
+            entry->value = value;
+            changed |= bit;
+        }
+    }
+    if (metrics & HEALTH_AGGREGATOR_MOVEMENT) s_last_movement = time(NULL);
+    if (changed && s_handler) s_handler(changed, s_context);
+}
+
+static void prv_timer_callback(void *context) {
+    logf();
+    s_timer = NULL;
+    prv_refresh(HEALTH_AGGREGATOR_MOVEMENT);
+}
+
+static void prv_health_handler(HealthEventType event, void *context) {
+    logf();
+    if (event == HealthEventSignificantUpdate) {
+        s_checked = 0;
+        s_available = 0;
+        prv_refresh(s_metrics);
+    } else if (event == HealthEventMovementUpdate) {
+        time_t elapsed = time(NULL) - s_last_movement;
+        if (elapsed >= s_min_interval) {
+            prv_refresh(HEALTH_AGGREGATOR_MOVEMENT);
+        } else if (!s_timer) {
+            s_timer = app_timer_register((s_min_interval - elapsed) * 1000, prv_timer_callback, NULL);
+        }
+    } else if (event == HealthEventHeartRateUpdate) {
+        prv_refresh(HealthAggregatorMetricHeartRate);
+    }
+}
+
+void health_aggregator_init(HealthAggregatorHandler handler, void *context) {
+    logf();
+    s_handler = handler;
+    s_context = context;
+}
+
+void health_aggregator_deinit(void) {
+    logf();
+    health_aggregator_set_metrics(HealthAggregatorMetricNone);
+    s_handler = NULL;
+    s_context = NULL;
+}
+
+void health_aggregator_set_metrics(uint8_t metrics) {
+    logf();
+    uint8_t added = metrics & ~s_metrics;
+    s_metrics = metrics;
+
+    if (metrics && !s_health_event_handle) {
+        s_health_event_handle = events_health_service_events_subscribe(prv_health_handler, NULL);
+    } else if (!metrics && s_health_event_handle) {
+        events_health_service_events_unsubscribe(s_health_event_handle);
+        s_health_event_handle = NULL;
+    }
+
+    if (!metrics && s_timer) {
+        app_timer_cancel(s_timer);
+        s_timer = NULL;
+    }
+
+    if (added) {
+        // force a notification so newly shown widgets get formatted
+        for (uint8_t i = 0; i < ARRAY_LENGTH(s_entries); i++) {
+            if (added & (1 << i)) s_entries[i].value = -1;
+        }
+        prv_refresh(added);
+    }
+}
+
+void health_aggregator_set_min_interval(uint16_t seconds) {
+    logf();
+    s_min_interval = seconds;
+}
+
+bool health_aggregator_peek(HealthAggregatorMetric metric, HealthValue *value) {
+    logf();
+    for (uint8_t i = 0; i < ARRAY_LENGTH(s_entries); i++) {
+        if (metric != (1 << i)) continue;
+        if (!(s_available & metric) || s_entries[i].value < 0) return false;
+        *value = s_entries[i].value;
+        return true;
+    }
+    return false;
+}
+#endif
@@ -0,0 +1,18 @@
+#pragma once
+#include <pebble.h>
+
+typedef enum {
+    HealthAggregatorMetricNone = 0,
+    HealthAggregatorMetricSteps = 1 << 0,
+    HealthAggregatorMetricDistance = 1 << 1,
+    HealthAggregatorMetricActiveSeconds = 1 << 2,
+    HealthAggregatorMetricHeartRate = 1 << 3
+} HealthAggregatorMetric;
+
+typedef void (*HealthAggregatorHandler)(uint8_t changed, void *context);
+
+void health_aggregator_init(HealthAggregatorHandler handler, void *context);
+void health_aggregator_deinit(void);
+void health_aggregator_set_metrics(uint8_t metrics);
+void health_aggregator_set_min_interval(uint16_t seconds);
+bool health_aggregator_peek(HealthAggregatorMetric metric, HealthValue *value);
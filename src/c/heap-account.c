@@ -0,0 +1,100 @@
+#include <pebble.h>
+#include "heap-account.h"
+#include "logging.h"
+
+#ifdef DEBUG
+
+#define HEAP_ACCOUNT_DEPTH 4
+
+typedef struct {
+    HeapSubsystem subsystem;
+    size_t used;
+    int32_t nested;
+} HeapAccountSpan;
+
+typedef struct {
+    int32_t current;
+    int32_t peak;
+} HeapAccountUsage;
+
+static const char *const s_names[] = {
+    [HeapSubsystemLayers] = "layers",
+    [HeapSubsystemFonts] = "fonts",
+    [HeapSubsystemPaths] = "paths",
+    [HeapSubsystemWeather] = "weather",
+    [HeapSubsystemGeocode] = "geocode",
+    [HeapSubsystemEvents] = "events",
+    [HeapSubsystemSettings] = "settings",
+    [HeapSubsystemOther] = "other",
+};
+
+static HeapAccountUsage s_usage[HeapSubsystemEnd];
+static HeapAccountSpan s_spans[HEAP_ACCOUNT_DEPTH];
+static uint8_t s_depth;
+static size_t s_peak_used;
+
+// Samples the heap, charging whatever no span accounts for to HeapSubsystemOther
+static void prv_track_peak(void) {
+    size_t used = heap_bytes_used();
+    int32_t accounted = 0;
+    for (uint i = 0; i < HeapSubsystemOther; i++) accounted += s_usage[i].current;
+    // growth inside spans still open is theirs once they end, less what their nested spans took
+    if (s_depth > 0) accounted += (int32_t) used - (int32_t) s_spans[0].used;
+    for (uint8_t i = 0; i < s_depth; i++) accounted -= s_spans[i].nested;
+    HeapAccountUsage *other = &s_usage[HeapSubsystemOther];
+    other->current = (int32_t) used - accounted;
+    if (other->current > other->peak) other->peak = other->current;
+
+    if (used <= s_peak_used) return;
+    s_peak_used = used;
+    if (used > HEAP_ACCOUNT_BUDGET) logw("heap peak %d over budget %d", (int) used, HEAP_ACCOUNT_BUDGET);
+}
+
+void heap_account_begin(HeapSubsystem subsystem) {
+    logf();
+    if (s_depth >= HEAP_ACCOUNT_DEPTH) {
+        loge("heap account spans nested too deep");
+        return;
+    }
+    prv_track_peak();
+    s_spans[s_depth++] = (HeapAccountSpan) {
+        .subsystem = subsystem,
+        .used = heap_bytes_used(),
+        .nested = 0
+    };
+}
+
+void heap_account_end(void) {
+    logf();
+    if (s_depth == 0) return;
+
+    HeapAccountSpan *span = &s_spans[--s_depth];
+    int32_t delta = (int32_t) heap_bytes_used() - (int32_t) span->used;
+    if (s_depth > 0) s_spans[s_depth - 1].nested += delta;
+
+    HeapAccountUsage *usage = &s_usage[span->subsystem];
+    usage->current += delta - span->nested;
+    if (usage->current > usage->peak) usage->peak = usage->current;
+    prv_track_peak();
+}
+
+bool heap_account_get(HeapSubsystem subsystem, int32_t *current, int32_t *peak) {
+    logf();
+    if (subsystem >= HeapSubsystemEnd) return false;
+    prv_track_peak();
+    if (current) *current = s_usage[subsystem].current;
+    if (peak) *peak = s_usage[subsystem].peak;
+    return true;
+}
+
+void heap_account_report(void) {
+    logf();
+    prv_track_peak();
+    for (uint i = 0; i < HeapSubsystemEnd; i++) {
+        logd("heap %s: %ld current, %ld peak", s_names[i], s_usage[i].current, s_usage[i].peak);
+    }
+    logd("heap: %d used, %d peak, %d free, budget %d", (int) heap_bytes_used(), (int) s_peak_used,
+         (int) heap_bytes_free(), HEAP_ACCOUNT_BUDGET);
+}
+
+#endif // DEBUG
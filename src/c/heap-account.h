@@ -0,0 +1,39 @@
+#pragma once
+#include <pebble.h>
+
+typedef enum {
+    HeapSubsystemLayers = 0,
+    HeapSubsystemFonts,
+    HeapSubsystemPaths,
+    HeapSubsystemWeather,
+    HeapSubsystemGeocode,
+    HeapSubsystemEvents,
+    HeapSubsystemSettings,
+    // whatever is in use outside every span, so the subsystems add up to heap_bytes_used()
+    HeapSubsystemOther,
+    HeapSubsystemEnd
+} HeapSubsystem;
+
+// Peak heap_bytes_used() the face should stay under, with room left for the system.
+// The host harness fails a run that goes over it.
+#if defined(PBL_PLATFORM_APLITE)
+#define HEAP_ACCOUNT_BUDGET 12000
+#elif defined(PBL_PLATFORM_DIORITE)
+#define HEAP_ACCOUNT_BUDGET 28000
+#else
+#define HEAP_ACCOUNT_BUDGET 64000
+#endif
+
+// Debug builds attribute heap_bytes_used() deltas between begin and end to a subsystem,
+// nested spans are only counted by the innermost one. Release builds compile it all away.
+#ifdef DEBUG
+void heap_account_begin(HeapSubsystem subsystem);
+void heap_account_end(void);
+bool heap_account_get(HeapSubsystem subsystem, int32_t *current, int32_t *peak);
+void heap_account_report(void);
+#else
+#define heap_account_begin(subsystem)
+#define heap_account_end()
+#define heap_account_get(subsystem, current, peak) (false)
+#define heap_account_report()
+#endif
@@ -2,8 +2,13 @@
 
 //#define TRACE
 //#define DEBUG
+// TRACE_RING is only set by the build (--with-trace-ring), so trace.c sees it as well
 
-#ifdef TRACE
+#ifdef TRACE_RING
+// binary records in a RAM ring buffer instead of the log channel, see trace.h
+#include "trace.h"
+#define logt(fmt, ...)
+#elif defined(TRACE)
 #define logt(fmt, ...) APP_LOG(APP_LOG_LEVEL_DEBUG_VERBOSE, fmt, ##__VA_ARGS__)
 #ifndef DEBUG
 #define DEBUG
@@ -22,4 +27,13 @@
 #define logw(fmt, ...) APP_LOG(APP_LOG_LEVEL_WARNING, fmt, ##__VA_ARGS__)
 #define loge(fmt, ...) APP_LOG(APP_LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
 
+#ifdef TRACE_RING
+#define logf(void) trace_record(__func__, 0, 0);
+#define logv(a, b) trace_record(__func__, (a), (b));
+// accessors called many times per frame stay out of the ring, so it spans whole frames
+#define logg(void)
+#else
 #define logf(void) logt("%s", __func__);
+#define logv(a, b) logt("%s: %d %d", __func__, (int) (a), (int) (b));
+#define logg(void) logf()
+#endif
@@ -6,7 +6,14 @@
 #include <pebble-fctx/fpath.h>
 #include "fctx-layer.h"
 #include "fctx-text-layer.h"
+#include "fb-capture.h"
 #include "weather.h"
+#include "widgets.h"
+#include "face-config.h"
+#include "health-aggregator.h"
+#include "persist-store.h"
+#include "heap-account.h"
+#include "ffont-cache.h"
 #include "logging.h"
 
 #ifdef PBL_PLATFORM_APLITE
@@ -16,36 +23,16 @@
 #define PBL_IF_APLITE_ELSE(A, B) (B)
 #endif
 
-#define WIDGET_BUF_LEN 16
-#define WIDGET_BUF_SIZEOF(b) sizeof(b) * WIDGET_BUF_LEN
-
-typedef enum {
-    WidgetTypeNone = 0,
-    WidgetTypeHumidity,
-    WidgetTypeFeelsLike,
-    WidgetTypeLowTemperature,
-    WidgetTypeHighTemperature,
-    WidgetTypeBattery,
-    WidgetTypeSteps,
-    WidgetTypeConnection,
-    WidgetTypeHeartRate,
-    WidgetTypeDistance,
-    WidgetTypeActiveSeconds,
-    WidgetTypeSeconds,
-    WidgetTypeSunrise,
-    WidgetTypeSunset,
-    WidgetTypeEnd
-} WidgetType;
 
 static Window *s_window;
 static FctxLayer *s_root_layer;
-static FctxLayer *s_grid_layer;
 static FctxLayer *s_weather_icon_layer;
 static FctxLayer *s_widget_container_layer;
+static const GRect s_widget_container_frame = { { 0, 72 + 52 }, { PBL_DISPLAY_WIDTH, PBL_DISPLAY_HEIGHT } };
 static FctxTextLayer *s_time_layer;
 static FctxTextLayer *s_date_layer;
 static FctxTextLayer *s_temperature_layer;
-static FctxTextLayer *s_widget_layers[PBL_IF_APLITE_ELSE(4, 8)];
+static FctxTextLayer *s_widget_layers[FACE_CONFIG_WIDGET_SLOTS];
 
 static FctxTextLayer** s_text_layers[] = {
     &s_time_layer,
@@ -63,6 +50,7 @@ static FctxTextLayer** s_text_layers[] = {
 #endif
 };
 static char s_widget_buffers[WidgetTypeEnd][WIDGET_BUF_LEN];
+static TimeUnits s_tick_units;
 
 typedef struct {
     uint32_t resource_id;
@@ -72,6 +60,16 @@ typedef struct {
 
 static WeatherIcon s_weather_icon;
 
+typedef struct {
+    uint32_t resource_id;
+    uint8_t scale_factor;
+    GColor color;
+    GColor background;
+    GBitmap *bitmap;
+} WeatherIconCache;
+
+static WeatherIconCache s_weather_icon_cache;
+
 static const WeatherIcon s_weather_icon_na = { RESOURCE_ID_WEATHER_NA, 7, { 0, -9 }};
 
 static const WeatherIcon const s_weather_icons_day[] = {
@@ -102,19 +100,66 @@ static EventHandle s_tick_timer_event_handle;
 static EventHandle s_weather_event_handle;
 static EventHandle s_settings_event_handle;
 static EventHandle s_battery_state_event_handle;
-#ifdef PBL_HEALTH
-static EventHandle s_health_event_handle;
-#endif
 static EventHandle s_connection_event_handle;
 
+static AppTimer *s_startup_timer;
+static bool s_started;
+#if defined(PROFILE) || defined(TRACE_RING)
+static EventHandle s_report_tap_event_handle;
+#endif
+#ifdef DEBUG
+static uint32_t s_startup_ms;
+#ifndef PBL_PLATFORM_APLITE
+// font loads once startup finished, frames after that must not load any
+static uint32_t s_font_loads;
+#endif
+
+static uint32_t prv_time_ms(void) {
+    logf();
+    time_t seconds;
+    uint16_t ms;
+    time_ms(&seconds, &ms);
+    return seconds * 1000 + ms;
+}
+#endif
+
 #ifndef PBL_PLATFORM_APLITE
 static EventHandle s_tap_event_handle;
 static bool s_tap_animated;
+
+// the second widget page sits this far below the first
+#define WIDGET_SCROLL_DISTANCE 44
+
+typedef struct {
+    FctxLayer *layer;
+    GBitmap *bitmap;
+    int16_t offset;
+    // pages, bit n for page n, whose captured widgets changed since
+    uint8_t stale;
+} WidgetScroll;
+
+static WidgetScroll s_widget_scroll;
 #ifdef PBL_PLATFORM_DIORITE
 static AppTimer *s_tap_timer;
 #endif // PBL_PLATFORM_DIORITE
 #endif // !PBL_PLATFORM_APLITE
 
+static void prv_mark_widget_dirty(WidgetType type) {
+    logf();
+    const FaceConfig *config = face_config_get();
+    for (uint i = 0; i < ARRAY_LENGTH(s_widget_layers); i++) {
+        if (config->widgets[i] != type) continue;
+        fctx_layer_mark_dirty(fctx_text_layer_get_fctx_layer(s_widget_layers[i]));
+#ifndef PBL_PLATFORM_APLITE
+        // a widget that changes while scrolling, like the seconds, is captured again
+        if (s_tap_animated) {
+            s_widget_scroll.stale |= 1 << (i / (FACE_CONFIG_WIDGET_SLOTS / 2));
+            fctx_layer_mark_dirty(s_widget_scroll.layer);
+        }
+#endif
+    }
+}
+
 static void prv_fctx_draw_rect(FContext *fctx, GRect rect) {
     logf();
     fctx_begin_fill(fctx);
@@ -124,24 +169,15 @@ static void prv_fctx_draw_rect(FContext *fctx, GRect rect) {
     fctx_line_to(fctx, FPoint(rect.origin.x, rect.origin.y + rect.size.h));
     fctx_close_path(fctx);
     fctx_end_fill(fctx);
+    fctx_layer_profile_fill();
 }
 
-static void prv_grid_layer_update_proc(FctxLayer *this, FContext *fctx) {
-    logf();
-    fctx_set_fill_color(fctx, enamel_get_COLOR_PINLINE());
-
-    GRect line_rect = GRect(0, 0, 1, 1);
-    fctx_set_scale(fctx, FPointOne, FPointI(PBL_DISPLAY_WIDTH, 2));
-    fctx_set_offset(fctx, FPointI(0, 72));
-    prv_fctx_draw_rect(fctx, line_rect);
-}
-
-static void prv_widget_container_layer_update_proc(FctxLayer *this, FContext *fctx) {
+static void prv_draw_widget_grid(FContext *fctx, GRect frame) {
     logf();
-    GRect frame = fctx_layer_get_frame(this);
     GRect line_rect = GRect(0, 0, 1, 1);
 
     fctx_set_scale(fctx, FPointOne, FPointI(frame.size.w, frame.size.h));
+    fctx_set_offset(fctx, FPointI(frame.origin.x, frame.origin.y));
     fctx_set_fill_color(fctx, enamel_get_COLOR_BACKGROUND());
     prv_fctx_draw_rect(fctx, line_rect);
 
@@ -158,38 +194,121 @@ static void prv_widget_container_layer_update_proc(FctxLayer *this, FContext *fc
     prv_fctx_draw_rect(fctx, line_rect);
 }
 
-static void prv_weather_icon_layer_update_proc(FctxLayer *this, FContext *fctx) {
+static void prv_background_update_proc(FctxLayer *this, FContext *fctx) {
     logf();
+    fctx_set_fill_color(fctx, enamel_get_COLOR_PINLINE());
+
+    GRect line_rect = GRect(0, 0, 1, 1);
+    fctx_set_scale(fctx, FPointOne, FPointI(PBL_DISPLAY_WIDTH, 2));
+    fctx_set_offset(fctx, FPointI(0, 72));
+    prv_fctx_draw_rect(fctx, line_rect);
+
+    prv_draw_widget_grid(fctx, s_widget_container_frame);
+}
+
+// Renders the icon on the background into the cache's own bitmap, which is blitted on later frames
+static bool prv_weather_icon_render(WeatherIconCache *cache, FContext *fctx, GSize size, GColor color, GColor background) {
+    logf();
+    if (cache->bitmap) {
+        GRect bounds = gbitmap_get_bounds(cache->bitmap);
+        if (!gsize_equal(&bounds.size, &size)) {
+            gbitmap_destroy(cache->bitmap);
+            cache->bitmap = NULL;
+        }
+    }
+    if (!cache->bitmap) {
+        heap_account_begin(HeapSubsystemPaths);
+        cache->bitmap = gbitmap_create_blank(size, PBL_IF_COLOR_ELSE(GBitmapFormat8Bit, GBitmapFormat1Bit));
+        heap_account_end();
+        if (!cache->bitmap) {
+            loge("failed to allocate weather icon bitmap");
+            return false;
+        }
+    }
+
+    heap_account_begin(HeapSubsystemPaths);
     FPath *path = fpath_create_from_resource(s_weather_icon.resource_id);
+    heap_account_end();
+    if (!path) return false;
+
+    FbRedirect saved;
+    if (!fb_redirect_begin(fctx->gctx, cache->bitmap, &saved)) {
+        fpath_destroy(path);
+        return false;
+    }
+    fctx_set_offset(fctx, FPointZero);
+    fctx_set_scale(fctx, FPointOne, FPointI(size.w, size.h));
+    fctx_set_fill_color(fctx, background);
+    prv_fctx_draw_rect(fctx, GRect(0, 0, 1, 1));
+
     uint8_t scale_factor = s_weather_icon.scale_factor;
     GPoint advance = s_weather_icon.advance;
     advance.x *= scale_factor;
     advance.y *= scale_factor;
-
     fctx_set_scale(fctx, FPoint(scale_factor, scale_factor), FPointOne);
-
     fctx_begin_fill(fctx);
-    fctx_set_fill_color(fctx, enamel_get_COLOR_TEXT());
+    fctx_set_fill_color(fctx, color);
     fctx_draw_commands(fctx, FPointI(advance.x, advance.y), path->data, path->size);
     fctx_end_fill(fctx);
+    fctx_layer_profile_fill();
+    fb_redirect_end(fctx->gctx, &saved);
 
+    heap_account_begin(HeapSubsystemPaths);
     fpath_destroy(path);
+    heap_account_end();
+    cache->resource_id = s_weather_icon.resource_id;
+    cache->scale_factor = scale_factor;
+    cache->color = color;
+    cache->background = background;
+    return true;
+}
+
+static void prv_weather_icon_layer_update_proc(FctxLayer *this, FContext *fctx) {
+    logf();
+    GPoint origin = fctx_layer_get_draw_origin(this);
+    GRect rect = GRect(origin.x, origin.y, PBL_DISPLAY_WIDTH / 2, 50);
+    GColor color = enamel_get_COLOR_TEXT();
+    GColor background = enamel_get_COLOR_BACKGROUND();
+
+    WeatherIconCache *cache = &s_weather_icon_cache;
+    GRect bounds = cache->bitmap ? gbitmap_get_bounds(cache->bitmap) : GRectZero;
+    bool valid = cache->bitmap && gsize_equal(&bounds.size, &rect.size) &&
+                 cache->resource_id == s_weather_icon.resource_id && cache->scale_factor == s_weather_icon.scale_factor &&
+                 gcolor_equal(cache->color, color) && gcolor_equal(cache->background, background);
+    if (!valid && !prv_weather_icon_render(cache, fctx, rect.size, color, background)) return;
+    graphics_draw_bitmap_in_rect(fctx->gctx, cache->bitmap, rect);
+}
+
+static void prv_widgets_update(WidgetSource source, const void *data, TimeUnits units_changed) {
+    logf();
+    const FaceConfig *config = face_config_get();
+    if (!(config->sources & source)) return;
+
+    // each visible type once, however many slots show it
+    for (WidgetType type = WidgetTypeNone + 1; type < WidgetTypeEnd; type++) {
+        if (!(config->visible & (1 << type))) continue;
+        const WidgetProvider *provider = widget_provider_get(type);
+        if (provider->source != source) continue;
+        if (source == WidgetSourceTick && !(provider->tick_units & units_changed)) continue;
+
+        char buf[WIDGET_BUF_LEN];
+        strncpy(buf, s_widget_buffers[type], WIDGET_BUF_LEN);
+        provider->format(s_widget_buffers[type], WIDGET_BUF_LEN, data);
+        if (strncmp(buf, s_widget_buffers[type], WIDGET_BUF_LEN) != 0) prv_mark_widget_dirty(type);
+    }
 }
 
 static void prv_tick_handler(struct tm *tick_time, TimeUnits units_changed) {
     logf();
-    static char buf_time[8];
-    strftime(buf_time, sizeof(buf_time), clock_is_24h_style() ? "%H:%M" : "%I:%M", tick_time);
-    if (enamel_get_LEADING_ZERO()) fctx_text_layer_set_text(s_time_layer, buf_time);
-    else fctx_text_layer_set_text(s_time_layer, buf_time + ((buf_time[0] == '0') ? 1 : 0));
+    if (units_changed & (MINUTE_UNIT | HOUR_UNIT | DAY_UNIT)) {
+        static char buf_time[8];
+        strftime(buf_time, sizeof(buf_time), clock_is_24h_style() ? "%H:%M" : "%I:%M", tick_time);
+        if (enamel_get_LEADING_ZERO()) fctx_text_layer_set_text(s_time_layer, buf_time);
+        else fctx_text_layer_set_text(s_time_layer, buf_time + ((buf_time[0] == '0') ? 1 : 0));
 
 #ifdef DEMO
-    fctx_text_layer_set_text(s_time_layer, "12:34");
+        fctx_text_layer_set_text(s_time_layer, "12:34");
 #endif
-
-    if (units_changed & SECOND_UNIT) {
-        char *s = s_widget_buffers[WidgetTypeSeconds];
-        strftime(s, WIDGET_BUF_SIZEOF(s), "SE: %S", tick_time);
     }
 
     if (units_changed & DAY_UNIT) {
@@ -197,6 +316,15 @@ static void prv_tick_handler(struct tm *tick_time, TimeUnits units_changed) {
         strftime(buf_date, sizeof(buf_date), "%a, %b %d", tick_time);
         fctx_text_layer_set_text(s_date_layer, buf_date);
     }
+
+    prv_widgets_update(WidgetSourceTick, tick_time, units_changed);
+
+#if defined(DEBUG) && !defined(PBL_PLATFORM_APLITE)
+    if (s_started && ffont_cache_load_count() != s_font_loads) {
+        logw("fonts loaded after warm-up: %lu", ffont_cache_load_count() - s_font_loads);
+        s_font_loads = ffont_cache_load_count();
+    }
+#endif
 }
 
 static void prv_weather_handler(GenericWeatherInfo *info, GenericWeatherStatus status, void *context) {
@@ -211,122 +339,108 @@ static void prv_weather_handler(GenericWeatherInfo *info, GenericWeatherStatus s
 #endif
 
     static char buf_temperature[8];
-    int unit = atoi(enamel_get_WEATHER_UNIT());
-    snprintf(buf_temperature, sizeof(buf_temperature), "%d°", unit == 1 ? info->temp_f : info->temp_c);
+    bool fahrenheit = face_config_get()->weather_unit == WeatherUnitFahrenheit;
+    snprintf(buf_temperature, sizeof(buf_temperature), "%d°", fahrenheit ? info->temp_f : info->temp_c);
     fctx_text_layer_set_text(s_temperature_layer, buf_temperature);
 
-    char *buf_humidity = s_widget_buffers[WidgetTypeHumidity];
-    snprintf(buf_humidity, WIDGET_BUF_SIZEOF(buf_humidity), "HU: %d%%", info->humidity);
-
-    char *buf_feels_like = s_widget_buffers[WidgetTypeFeelsLike];
-    snprintf(buf_feels_like, WIDGET_BUF_SIZEOF(buf_feels_like), "FL: %d°", unit == 1 ? info->temp_feels_like_f : info->temp_feels_like_c);
-
-    char *buf_temp_low = s_widget_buffers[WidgetTypeLowTemperature];
-    snprintf(buf_temp_low, WIDGET_BUF_SIZEOF(buf_temp_low), "LO: %d°", unit == 1 ? info->temp_low_f: info->temp_low_c);
-
-    char *buf_temp_high = s_widget_buffers[WidgetTypeHighTemperature];
-    snprintf(buf_temp_high, WIDGET_BUF_SIZEOF(buf_temp_high), "HI: %d°", unit == 1 ? info->temp_high_f: info->temp_high_c);
-
-    struct tm *tick_time = localtime(&info->timesunrise);
-    char *buf_sunrise = s_widget_buffers[WidgetTypeSunrise];
-    strftime(buf_sunrise, WIDGET_BUF_SIZEOF(buf_sunrise), clock_is_24h_style() ? "SR: %H:%M" : "SR: %I:%M", tick_time);
-
-    tick_time = localtime(&info->timesunset);
-    char *buf_sunset = s_widget_buffers[WidgetTypeSunset];
-    strftime(buf_sunset, WIDGET_BUF_SIZEOF(buf_sunset), clock_is_24h_style() ? "SS: %H:%M" : "SS: %I:%M", tick_time);
+    fctx_layer_mark_dirty(s_weather_icon_layer);
+    prv_widgets_update(WidgetSourceWeather, info, 0);
 
 #ifdef DEMO
     fctx_text_layer_set_text(s_temperature_layer, "19°");
-    snprintf(buf_humidity, WIDGET_BUF_SIZEOF(buf_humidity), "HU: 80%%");
-    snprintf(buf_feels_like, WIDGET_BUF_SIZEOF(buf_feels_like), "FL: 20°");
-    snprintf(buf_temp_low, WIDGET_BUF_SIZEOF(buf_temp_low), "LO: 15°");
-    snprintf(buf_temp_high, WIDGET_BUF_SIZEOF(buf_temp_high), "HI: 20°");
+    snprintf(s_widget_buffers[WidgetTypeHumidity], WIDGET_BUF_LEN, "HU: 80%%");
+    snprintf(s_widget_buffers[WidgetTypeFeelsLike], WIDGET_BUF_LEN, "FL: 20°");
+    snprintf(s_widget_buffers[WidgetTypeLowTemperature], WIDGET_BUF_LEN, "LO: 15°");
+    snprintf(s_widget_buffers[WidgetTypeHighTemperature], WIDGET_BUF_LEN, "HI: 20°");
 #endif
 }
 
 static void prv_battery_state_handler(BatteryChargeState charge_state) {
     logf();
-    char *s = s_widget_buffers[WidgetTypeBattery];
-    snprintf(s, WIDGET_BUF_SIZEOF(s), "BT: %d%%", charge_state.charge_percent);
-    fctx_layer_mark_dirty(s_root_layer);
+    prv_widgets_update(WidgetSourceBattery, &charge_state, 0);
 }
 
 #ifdef PBL_HEALTH
-static void prv_health_handler(HealthEventType event, void *context) {
-    logf();
-    if (event == HealthEventSignificantUpdate || event == HealthEventMovementUpdate) {
-        time_t start = time_start_of_today();
-        time_t end = time(NULL);
-        HealthServiceAccessibilityMask mask = health_service_metric_accessible(HealthMetricStepCount, start, end);
-        if (mask & HealthServiceAccessibilityMaskAvailable) {
-            HealthValue steps = health_service_sum_today(HealthMetricStepCount);
-            char *s = s_widget_buffers[WidgetTypeSteps];
-            if (steps < 1000) snprintf(s, WIDGET_BUF_SIZEOF(s), "ST: %ld", steps);
-            else snprintf(s, WIDGET_BUF_SIZEOF(s), "ST: %ld.%ldK", steps / 1000, steps / 100 % 10);
-        }
+static void prv_health_handler(uint8_t changed, void *context) {
+    logf();
+    prv_widgets_update(WidgetSourceHealth, NULL, 0);
+}
+#endif // PBL_HEALTH
 
-        mask = health_service_metric_accessible(HealthMetricWalkedDistanceMeters, start, end);
-        if (mask & HealthServiceAccessibilityMaskAvailable) {
-            HealthValue distance = health_service_sum_today(HealthMetricWalkedDistanceMeters);
-            MeasurementSystem system = health_service_get_measurement_system_for_display(HealthMetricWalkedDistanceMeters);
-            char *s = s_widget_buffers[WidgetTypeDistance];
-            if (system == MeasurementSystemMetric) {
-                if (distance < 100) snprintf(s, WIDGET_BUF_SIZEOF(s), "DI: %ldm", distance);
-                else if (distance < 1000) snprintf(s, WIDGET_BUF_SIZEOF(s), "DI: .%ldkm", distance / 100);
-                else snprintf(s, WIDGET_BUF_SIZEOF(s), "DI: %ldkm", distance / 1000);
-            } else {
-                uint tenths = distance * 10 / 1609 % 10;
-                uint whole = distance / 1609;
-                if (whole < 10) snprintf(s, WIDGET_BUF_SIZEOF(s), "DI: %d.%dmi", whole, tenths);
-                else snprintf(s, WIDGET_BUF_SIZEOF(s), "DI: %dmi", whole);
-            }
-
-            mask = health_service_metric_accessible(HealthMetricActiveSeconds, start, end);
-            if (mask & HealthServiceAccessibilityMaskAvailable) {
-                HealthValue active_seconds = health_service_sum_today(HealthMetricActiveSeconds);
-                uint minutes = active_seconds / 60;
-                uint hours = minutes / 60;
-                minutes %= 60;
-
-                struct tm t = {
-                    .tm_hour = hours,
-                    .tm_min = minutes
-                };
-                char *s = s_widget_buffers[WidgetTypeActiveSeconds];
-                strftime(s, WIDGET_BUF_SIZEOF(s), "AT:%k:%M", &t);
-            }
-        }
+static void prv_connection_handler(bool connected) {
+    logf();
+    prv_widgets_update(WidgetSourceConnection, &connected, 0);
+}
 
-        fctx_layer_mark_dirty(s_root_layer);
+#ifndef PBL_PLATFORM_APLITE
+// Draws one widget page with its grid over the band, where the scroll blit covers it later
+static void prv_widget_page_draw(FContext *fctx, GRect band, uint8_t page) {
+    logf();
+    prv_draw_widget_grid(fctx, band);
+    uint8_t first = page * FACE_CONFIG_WIDGET_SLOTS / 2;
+    for (uint i = first; i < first + FACE_CONFIG_WIDGET_SLOTS / 2; i++) {
+        fctx_layer_draw(fctx_text_layer_get_fctx_layer(s_widget_layers[i]), fctx, GPoint(0, -WIDGET_SCROLL_DISTANCE * page));
     }
+}
 
-#ifdef PBL_PLATFORM_DIORITE
-    if (event == HealthEventSignificantUpdate || event == HealthEventHeartRateUpdate) {
-        time_t now = time(NULL);
-        HealthServiceAccessibilityMask mask = health_service_metric_accessible(HealthMetricHeartRateBPM, now, now);
-        if (mask & HealthServiceAccessibilityMaskAvailable) {
-            HealthValue hr = health_service_peek_current_value(HealthMetricHeartRateBPM);
-            char *s = s_widget_buffers[WidgetTypeHeartRate];
-            snprintf(s, WIDGET_BUF_SIZEOF(s), "HR: %ld", hr);
-        }
-
-        fctx_layer_mark_dirty(s_root_layer);
+// While scrolling, both widget pages are one bitmap blitted at the scroll offset and
+// the widget container is hidden, so text is only rasterized for pages that changed.
+static void prv_widget_scroll_layer_update_proc(FctxLayer *this, FContext *fctx) {
+    logf();
+    WidgetScroll *scroll = &s_widget_scroll;
+    if (!s_tap_animated) return;
+
+    GContext *ctx = fctx->gctx;
+    GRect band = GRect(0, s_widget_container_frame.origin.y, PBL_DISPLAY_WIDTH, WIDGET_SCROLL_DISTANCE);
+    GSize size = GSize(PBL_DISPLAY_WIDTH, WIDGET_SCROLL_DISTANCE * 2);
+
+    for (uint8_t page = 0; page < 2 && scroll->stale; page++) {
+        if (!(scroll->stale & (1 << page))) continue;
+        prv_widget_page_draw(fctx, band, page);
+        scroll->bitmap = fb_capture_into(ctx, band, scroll->bitmap, size, GPoint(0, WIDGET_SCROLL_DISTANCE * page));
+        if (!scroll->bitmap) break;
+        scroll->stale &= ~(1 << page);
     }
-#endif // PBL_PLATFORM_DIORITE
+    // without a bitmap the first page stays put, drawn every frame
+    if (!scroll->bitmap) {
+        prv_widget_page_draw(fctx, band, 0);
+        return;
+    }
+
+    int16_t h = WIDGET_SCROLL_DISTANCE + scroll->offset;
+    gbitmap_set_bounds(scroll->bitmap, GRect(0, 0, size.w, h));
+    graphics_draw_bitmap_in_rect(ctx, scroll->bitmap, GRect(0, band.origin.y - scroll->offset, size.w, h));
+    gbitmap_set_bounds(scroll->bitmap, GRect(0, 0, size.w, size.h));
 }
-#endif // PBL_HEALTH
 
-static void prv_connection_handler(bool connected) {
+static void prv_widget_scroll_update(Animation *animation, const AnimationProgress progress) {
     logf();
-    char *s = s_widget_buffers[WidgetTypeConnection];
-    snprintf(s, WIDGET_BUF_SIZEOF(s), "CN: %s", connected ? "ON" : "OFF");
-    fctx_layer_mark_dirty(s_root_layer);
+    int16_t offset = WIDGET_SCROLL_DISTANCE * progress / ANIMATION_NORMALIZED_MAX;
+    s_widget_scroll.offset = offset;
+    fctx_layer_set_damage(s_widget_scroll.layer, GRect(0, WIDGET_SCROLL_DISTANCE - offset, PBL_DISPLAY_WIDTH, WIDGET_SCROLL_DISTANCE + offset));
+}
+
+static const AnimationImplementation s_widget_scroll_implementation = {
+    .update = prv_widget_scroll_update
+};
+
+// The scroll layer draws both pages from here on, starting with capturing them
+static void prv_tap_animation_started(Animation *animation, void *context) {
+    logf();
+    s_widget_scroll.stale = 0x3;
+    fctx_layer_set_hidden(s_widget_container_layer, true);
+    fctx_layer_set_damage(s_widget_scroll.layer, GRect(0, WIDGET_SCROLL_DISTANCE, PBL_DISPLAY_WIDTH, WIDGET_SCROLL_DISTANCE));
 }
 
-#ifndef PBL_PLATFORM_APLITE
 static void prv_tap_animation_stopped(Animation *animation, bool finished, void *context) {
     logf();
     s_tap_animated = false;
+    s_widget_scroll.stale = 0;
+    s_widget_scroll.offset = 0;
+    fctx_layer_set_hidden(s_widget_container_layer, false);
+    fctx_layer_set_damage(s_widget_scroll.layer, GRectZero);
+    if (s_widget_scroll.bitmap) gbitmap_destroy(s_widget_scroll.bitmap);
+    s_widget_scroll.bitmap = NULL;
 #ifdef PBL_PLATFORM_DIORITE
     if (s_tap_timer) {
         app_timer_cancel(s_tap_timer);
@@ -358,62 +472,69 @@ static void prv_tap_handler(AccelAxisType axis, int32_t direction) {
 
     s_tap_animated = true;
 
-    GRect from = fctx_layer_get_frame(s_widget_container_layer);
-    GRect to = GRect(from.origin.x, from.origin.y - 44, from.size.w, from.size.h);
-    PropertyAnimation *animation = property_animation_create_layer_frame(fctx_layer_get_layer(s_widget_container_layer), &from, &to);
+    Animation *animation = animation_create();
+    animation_set_implementation(animation, &s_widget_scroll_implementation);
 
-    Animation *clone = animation_clone(property_animation_get_animation(animation));
+    Animation *clone = animation_clone(animation);
+    animation_set_handlers(animation, (AnimationHandlers) {
+        .started = prv_tap_animation_started
+    }, NULL);
     animation_set_handlers(clone, (AnimationHandlers) {
         .stopped = prv_tap_animation_stopped
     }, NULL);
     animation_set_reverse(clone, true);
     animation_set_delay(clone, 5000);
 
-    Animation *sequence = animation_sequence_create(property_animation_get_animation(animation), clone, NULL);
+    Animation *sequence = animation_sequence_create(animation, clone, NULL);
     s_tap_animated = animation_schedule(sequence);
 }
 #endif // !PBL_PLATFORM_APLITE
 
-static bool prv_has_widget_type(WidgetType type) {
-    WidgetType widget_nw = atoi(enamel_get_WIDGET_NW());
-    WidgetType widget_ne = atoi(enamel_get_WIDGET_NE());
-    WidgetType widget_sw = atoi(enamel_get_WIDGET_SW());
-    WidgetType widget_se = atoi(enamel_get_WIDGET_SE());
-    bool widgets = widget_nw == type || widget_ne == type || widget_sw == type || widget_se == type;
-#ifdef PBL_PLATFORM_APLITE
-    return widgets;
-#else
-    if (!enamel_get_EXTRA_WIDGETS_ENABLED()) return widgets;
-
-    widget_nw = atoi(enamel_get_EXTRA_WIDGET_NW());
-    widget_ne = atoi(enamel_get_EXTRA_WIDGET_NE());
-    widget_sw = atoi(enamel_get_WIDGET_SW());
-    widget_se = atoi(enamel_get_WIDGET_SE());
-    bool extra_widgets = widget_nw == type || widget_ne == type || widget_sw == type || widget_se == type;
-    return widgets || extra_widgets;
+#if defined(PROFILE) || defined(TRACE_RING)
+// Profile and trace builds report on a wrist flick, covering what happened since the last one
+static void prv_report_tap_handler(AccelAxisType axis, int32_t direction) {
+    logf();
+    fctx_layer_profile_report(s_root_layer);
+#ifdef TRACE_RING
+    trace_dump();
 #endif
 }
+#endif
 
-static void prv_settings_handler(void *context) {
+// Everything needed to paint a frame, without touching any service
+static void prv_appearance_update(void) {
     logf();
-    prv_weather_handler(weather_peek(), weather_status_peek(), NULL);
-
-    connection_vibes_set_state(atoi(enamel_get_CONNECTION_VIBE()));
-    hourly_vibes_set_enabled(enamel_get_HOURLY_VIBE());
+    const FaceConfig *config = face_config_get();
+    for (uint i = 0; i < ARRAY_LENGTH(s_widget_layers); i++) {
+        fctx_text_layer_set_text(s_widget_layers[i], s_widget_buffers[config->widgets[i]]);
+    }
 
     for (uint i = 0; i < ARRAY_LENGTH(s_text_layers); i++) {
         fctx_text_layer_set_color(*s_text_layers[i], enamel_get_COLOR_TEXT());
     }
 
-    bool needs_seconds = prv_has_widget_type(WidgetTypeSeconds);
-    if (s_tick_timer_event_handle) events_tick_timer_service_unsubscribe(s_tick_timer_event_handle);
     time_t now = time(NULL);
-    prv_tick_handler(localtime(&now), DAY_UNIT | SECOND_UNIT);
-    s_tick_timer_event_handle = events_tick_timer_service_subscribe(needs_seconds ? SECOND_UNIT : MINUTE_UNIT, prv_tick_handler);
+    prv_tick_handler(localtime(&now), SECOND_UNIT | MINUTE_UNIT | HOUR_UNIT | DAY_UNIT);
+
+    fctx_text_layer_set_glyph_atlas(s_time_layer, "0123456789:", enamel_get_COLOR_BACKGROUND());
+    fctx_layer_set_background_color(s_root_layer, enamel_get_COLOR_BACKGROUND());
+    fctx_layer_invalidate_background(s_root_layer);
+}
+
+// Everything settings decide beyond the appearance: vibes, subscriptions and widget data
+static void prv_services_update(void) {
+    logf();
+    const FaceConfig *config = face_config_get();
+    WidgetSource sources = config->sources;
+
+    prv_weather_handler(weather_peek(), weather_status_peek(), NULL);
 
-    bool needs_battery = prv_has_widget_type(WidgetTypeBattery);
+    connection_vibes_set_state(config->connection_vibe);
+    hourly_vibes_set_enabled(enamel_get_HOURLY_VIBE());
+
+    bool needs_battery = sources & WidgetSourceBattery;
+    if (needs_battery) prv_battery_state_handler(battery_state_service_peek());
     if (needs_battery && !s_battery_state_event_handle) {
-        prv_battery_state_handler(battery_state_service_peek());
         s_battery_state_event_handle = events_battery_state_service_subscribe(prv_battery_state_handler);
     } else if (!needs_battery && s_battery_state_event_handle) {
         events_battery_state_service_unsubscribe(s_battery_state_event_handle);
@@ -421,24 +542,18 @@ static void prv_settings_handler(void *context) {
     }
 
 #ifdef PBL_HEALTH
-    bool needs_health = prv_has_widget_type(WidgetTypeSteps) ||
-                        prv_has_widget_type(WidgetTypeDistance) ||
-                        prv_has_widget_type(WidgetTypeHeartRate);
-    if (needs_health && !s_health_event_handle) {
-        prv_health_handler(HealthEventSignificantUpdate, NULL);
-        s_health_event_handle = events_health_service_events_subscribe(prv_health_handler, NULL);
-    } else if (!needs_health && s_health_event_handle) {
-        events_health_service_events_unsubscribe(s_health_event_handle);
-        s_health_event_handle = NULL;
-    }
+    bool needs_health = sources & WidgetSourceHealth;
+    health_aggregator_set_min_interval(config->health_interval);
+    health_aggregator_set_metrics(config->health_metrics);
+    if (needs_health) prv_health_handler(config->health_metrics, NULL);
 
     connection_vibes_enable_health(needs_health);
     hourly_vibes_enable_health(needs_health);
 #endif
 
-    bool needs_connection = prv_has_widget_type(WidgetTypeConnection);
+    bool needs_connection = sources & WidgetSourceConnection;
+    if (needs_connection) prv_connection_handler(connection_service_peek_pebble_app_connection());
     if (needs_connection && !s_connection_event_handle) {
-        prv_connection_handler(connection_service_peek_pebble_app_connection());
         s_connection_event_handle = events_connection_service_subscribe((ConnectionHandlers) {
             .pebble_app_connection_handler = prv_connection_handler
         });
@@ -448,41 +563,106 @@ static void prv_settings_handler(void *context) {
     }
 
 #ifndef PBL_PLATFORM_APLITE
-    if (enamel_get_EXTRA_WIDGETS_ENABLED() && !s_tap_event_handle) {
+    if (config->extra_widgets && !s_tap_event_handle) {
         s_tap_event_handle = events_accel_tap_service_subscribe(prv_tap_handler);
-    } else if (!enamel_get_EXTRA_WIDGETS_ENABLED() && s_tap_event_handle) {
+    } else if (!config->extra_widgets && s_tap_event_handle) {
         events_accel_tap_service_unsubscribe(s_tap_event_handle);
         s_tap_event_handle = NULL;
     }
 #endif
 
-    WidgetType widget_types[] = {
-        atoi(enamel_get_WIDGET_NW()),
-        atoi(enamel_get_WIDGET_NE()),
-        atoi(enamel_get_WIDGET_SW()),
-        atoi(enamel_get_WIDGET_SE()),
-#ifndef PBL_PLATFORM_APLITE
-        atoi(enamel_get_EXTRA_WIDGET_NW()),
-        atoi(enamel_get_EXTRA_WIDGET_NE()),
-        atoi(enamel_get_EXTRA_WIDGET_SW()),
-        atoi(enamel_get_EXTRA_WIDGET_SE()),
-#endif
-    };
+    TimeUnits tick_units = config->tick_units;
+    if (!s_tick_timer_event_handle || tick_units != s_tick_units) {
+        if (s_tick_timer_event_handle) events_tick_timer_service_unsubscribe(s_tick_timer_event_handle);
+        s_tick_units = tick_units;
+        s_tick_timer_event_handle = events_tick_timer_service_subscribe(tick_units, prv_tick_handler);
+    }
+}
+
+static void prv_settings_handler(void *context) {
+    logf();
+    prv_appearance_update();
+    prv_services_update();
+}
 
+// First stage of startup: paint from the clock and whatever was persisted by the last run
+static void prv_restore_persisted(void) {
+    logf();
+    const FaceConfig *config = face_config_get();
     for (uint i = 0; i < ARRAY_LENGTH(s_widget_layers); i++) {
-        fctx_text_layer_set_text(s_widget_layers[i], s_widget_buffers[widget_types[i]]);
+        const char *text = persist_store_get_widget_text(i);
+        if (text) strncpy(s_widget_buffers[config->widgets[i]], text, WIDGET_BUF_LEN - 1);
     }
 
-    window_set_background_color(s_window, enamel_get_COLOR_BACKGROUND());
+    GenericWeatherInfo info;
+    memset(&info, 0, sizeof(info));
+    if (persist_store_get_weather(&info)) prv_weather_handler(&info, persist_store_get_status(), NULL);
+    else s_weather_icon = s_weather_icon_na;
+
+    prv_appearance_update();
+}
+
+static void prv_save_persisted(void) {
+    logf();
+    const FaceConfig *config = face_config_get();
+    for (uint i = 0; i < ARRAY_LENGTH(s_widget_layers); i++) {
+        persist_store_set_widget_text(i, s_widget_buffers[config->widgets[i]]);
+    }
+}
+
+// Second stage of startup, one event loop turn after the window was pushed
+static void prv_startup_timer_callback(void *context) {
+    logf();
+    s_startup_timer = NULL;
+#ifdef DEBUG
+    logd("first stage took %d ms", (int) (prv_time_ms() - s_startup_ms));
+#endif
+
+    heap_account_begin(HeapSubsystemWeather);
+    weather_init();
+    heap_account_end();
+
+    heap_account_begin(HeapSubsystemEvents);
+    connection_vibes_init();
+    hourly_vibes_init();
+    uint32_t const pattern[] = { 100 };
+    hourly_vibes_set_pattern((VibePattern) {
+        .durations = pattern,
+        .num_segments = 1
+    });
+
+    events_app_message_open();
+
+    s_weather_event_handle = events_weather_subscribe(prv_weather_handler, NULL);
+#ifdef PBL_HEALTH
+    health_aggregator_init(prv_health_handler, NULL);
+#endif
+
+    // the appearance was already applied by the first stage, with the same settings
+    prv_services_update();
+    s_settings_event_handle = enamel_settings_received_subscribe(prv_settings_handler, NULL);
+#if defined(PROFILE) || defined(TRACE_RING)
+    s_report_tap_event_handle = events_accel_tap_service_subscribe(prv_report_tap_handler);
+#endif
+    heap_account_end();
+    s_started = true;
+#if defined(DEBUG) && !defined(PBL_PLATFORM_APLITE)
+    s_font_loads = ffont_cache_load_count();
+#endif
+
+    heap_account_report();
 }
 
 static void prv_window_load(Window *window) {
     logf();
+    heap_account_begin(HeapSubsystemLayers);
+    // root, weather icon, widget container and widget scroll plus the text layers
+    fctx_layer_pool_init(PBL_IF_APLITE_ELSE(3, 4) + ARRAY_LENGTH(s_text_layers), fctx_text_layer_data_size());
     s_root_layer = window_get_root_fctx_layer(window);
+    fctx_layer_set_name(s_root_layer, "background");
+    window_set_background_color(window, GColorClear);
 
-    s_grid_layer = fctx_layer_create(GRect(0, 0, PBL_DISPLAY_WIDTH, PBL_DISPLAY_HEIGHT));
-    fctx_layer_set_update_proc(s_grid_layer, prv_grid_layer_update_proc);
-    fctx_layer_add_child(s_root_layer, s_grid_layer);
+    fctx_layer_set_background_update_proc(s_root_layer, prv_background_update_proc);
 
     s_time_layer = fctx_text_layer_create(GRect(PBL_IF_APLITE_ELSE(0, PBL_DISPLAY_WIDTH / 2), PBL_IF_APLITE_ELSE(-8, 0), PBL_DISPLAY_WIDTH, PBL_DISPLAY_HEIGHT));
     fctx_text_layer_set_font(s_time_layer, RESOURCE_ID_TEXT_FFONT);
@@ -490,6 +670,7 @@ static void prv_window_load(Window *window) {
     fctx_text_layer_set_anchor(s_time_layer, FTextAnchorTop);
     fctx_text_layer_set_color(s_time_layer, GColorWhite);
     fctx_text_layer_set_text_size(s_time_layer, 56);
+    fctx_layer_set_name(fctx_text_layer_get_fctx_layer(s_time_layer), "time");
     fctx_layer_add_child(s_root_layer, fctx_text_layer_get_fctx_layer(s_time_layer));
 
     s_date_layer = fctx_text_layer_create(GRect(PBL_IF_APLITE_ELSE(0, PBL_DISPLAY_WIDTH / 2), PBL_IF_APLITE_ELSE(42, 70), PBL_DISPLAY_WIDTH, PBL_DISPLAY_HEIGHT));
@@ -498,10 +679,13 @@ static void prv_window_load(Window *window) {
     fctx_text_layer_set_anchor(s_date_layer, FTextAnchorBottom);
     fctx_text_layer_set_color(s_date_layer, GColorWhite);
     fctx_text_layer_set_text_size(s_date_layer, 18);
+    fctx_layer_set_name(fctx_text_layer_get_fctx_layer(s_date_layer), "date");
     fctx_layer_add_child(s_root_layer, fctx_text_layer_get_fctx_layer(s_date_layer));
 
     s_weather_icon_layer = fctx_layer_create(GRect(0, 74, PBL_DISPLAY_WIDTH, PBL_DISPLAY_HEIGHT));
     fctx_layer_set_update_proc(s_weather_icon_layer, prv_weather_icon_layer_update_proc);
+    fctx_layer_set_damage(s_weather_icon_layer, GRect(0, 0, PBL_DISPLAY_WIDTH / 2, 50));
+    fctx_layer_set_name(s_weather_icon_layer, "weather icon");
     fctx_layer_add_child(s_root_layer, s_weather_icon_layer);
 
 #ifdef PBL_PLATFORM_APLITE
@@ -514,10 +698,11 @@ static void prv_window_load(Window *window) {
     fctx_text_layer_set_anchor(s_temperature_layer, FTextAnchorMiddle);
     fctx_text_layer_set_color(s_temperature_layer, GColorWhite);
     fctx_text_layer_set_text_size(s_temperature_layer, 36);
+    fctx_layer_set_name(fctx_text_layer_get_fctx_layer(s_temperature_layer), "temperature");
     fctx_layer_add_child(s_root_layer, fctx_text_layer_get_fctx_layer(s_temperature_layer));
 
-    s_widget_container_layer = fctx_layer_create(GRect(0, 72 + 52, PBL_DISPLAY_WIDTH, PBL_DISPLAY_HEIGHT));
-    fctx_layer_set_update_proc(s_widget_container_layer, prv_widget_container_layer_update_proc);
+    s_widget_container_layer = fctx_layer_create(s_widget_container_frame);
+    fctx_layer_set_name(s_widget_container_layer, "widget grid");
     fctx_layer_add_child(s_root_layer, s_widget_container_layer);
 
     uint8_t widget_width = PBL_DISPLAY_WIDTH / 2 - 1;
@@ -532,58 +717,86 @@ static void prv_window_load(Window *window) {
         fctx_text_layer_set_anchor(s_widget_layers[i], FTextAnchorTop);
         fctx_text_layer_set_color(s_widget_layers[i], GColorWhite);
         fctx_text_layer_set_text_size(s_widget_layers[i], 16);
+        fctx_layer_set_name(fctx_text_layer_get_fctx_layer(s_widget_layers[i]), "widget");
         fctx_layer_add_child(s_widget_container_layer, fctx_text_layer_get_fctx_layer(s_widget_layers[i]));
     }
 
-    memset(s_widget_buffers, 0, sizeof(s_widget_buffers));
+#ifndef PBL_PLATFORM_APLITE
+    s_widget_scroll.layer = fctx_layer_create(GRect(0, s_widget_container_frame.origin.y - WIDGET_SCROLL_DISTANCE, PBL_DISPLAY_WIDTH, WIDGET_SCROLL_DISTANCE * 2));
+    fctx_layer_set_update_proc(s_widget_scroll.layer, prv_widget_scroll_layer_update_proc);
+    fctx_layer_set_damage(s_widget_scroll.layer, GRectZero);
+    fctx_layer_set_name(s_widget_scroll.layer, "widget scroll");
+    fctx_layer_add_child(s_root_layer, s_widget_scroll.layer);
+#endif
 
-    s_weather_event_handle = events_weather_subscribe(prv_weather_handler, NULL);
+    memset(s_widget_buffers, 0, sizeof(s_widget_buffers));
 
-    prv_settings_handler(NULL);
-    s_settings_event_handle = enamel_settings_received_subscribe(prv_settings_handler, NULL);
+    prv_restore_persisted();
+    heap_account_end();
 }
 
 static void prv_window_unload(Window *window) {
     logf();
+#ifdef TRACE_RING
+    trace_dump();
+#endif
 #ifdef PBL_PLATFORM_DIORITE
     if (s_tap_timer) app_timer_cancel(s_tap_timer);
 #endif
 
-    if (s_connection_event_handle) events_connection_service_unsubscribe(s_connection_event_handle);
+    if (s_startup_timer) app_timer_cancel(s_startup_timer);
+    s_startup_timer = NULL;
+
+    if (s_started) {
+        prv_save_persisted();
+
+        if (s_connection_event_handle) events_connection_service_unsubscribe(s_connection_event_handle);
 #ifdef PBL_HEALTH
-    if (s_health_event_handle) events_health_service_events_unsubscribe(s_health_event_handle);
+        health_aggregator_deinit();
 #endif
-    if (s_battery_state_event_handle) events_battery_state_service_unsubscribe(s_battery_state_event_handle);
-    enamel_settings_received_unsubscribe(s_settings_event_handle);
+        if (s_battery_state_event_handle) events_battery_state_service_unsubscribe(s_battery_state_event_handle);
+        enamel_settings_received_unsubscribe(s_settings_event_handle);
 #ifndef PBL_PLATFORM_APLITE
-    if (s_tap_event_handle) events_accel_tap_service_unsubscribe(s_tap_event_handle);
+        if (s_tap_event_handle) events_accel_tap_service_unsubscribe(s_tap_event_handle);
+#endif
+#if defined(PROFILE) || defined(TRACE_RING)
+        events_accel_tap_service_unsubscribe(s_report_tap_event_handle);
 #endif
-    events_weather_unsubscribe(s_weather_event_handle);
-    events_tick_timer_service_unsubscribe(s_tick_timer_event_handle);
+        events_weather_unsubscribe(s_weather_event_handle);
+        events_tick_timer_service_unsubscribe(s_tick_timer_event_handle);
+    }
 
+    heap_account_begin(HeapSubsystemLayers);
     for(uint i = 0; i < ARRAY_LENGTH(s_text_layers); i++) fctx_text_layer_destroy(*s_text_layers[i]);
 
     fctx_layer_destroy(s_weather_icon_layer);
+    if (s_weather_icon_cache.bitmap) gbitmap_destroy(s_weather_icon_cache.bitmap);
+    s_weather_icon_cache.bitmap = NULL;
     fctx_layer_destroy(s_widget_container_layer);
-    fctx_layer_destroy(s_grid_layer);
+#ifndef PBL_PLATFORM_APLITE
+    fctx_layer_destroy(s_widget_scroll.layer);
+    if (s_widget_scroll.bitmap) gbitmap_destroy(s_widget_scroll.bitmap);
+    s_widget_scroll.bitmap = NULL;
+#endif
     fctx_layer_destroy(s_root_layer);
+    fctx_layer_pool_deinit();
+    heap_account_end();
+    heap_account_report();
 }
 
 static void prv_init(void) {
     logf();
     setlocale(LC_ALL, "");
 
-    enamel_init();
-    weather_init();
-    connection_vibes_init();
-    hourly_vibes_init();
-    uint32_t const pattern[] = { 100 };
-    hourly_vibes_set_pattern((VibePattern) {
-        .durations = pattern,
-        .num_segments = 1
-    });
+#ifdef DEBUG
+    s_startup_ms = prv_time_ms();
+#endif
 
-    events_app_message_open();
+    heap_account_begin(HeapSubsystemSettings);
+    enamel_init();
+    face_config_init();
+    heap_account_end();
+    persist_store_init();
 
     s_window = window_create();
     window_set_window_handlers(s_window, (WindowHandlers) {
@@ -591,15 +804,22 @@ static void prv_init(void) {
         .unload = prv_window_unload
     });
     window_stack_push(s_window, true);
+
+    // services, weather and health are set up once the first frame is on its way
+    s_startup_timer = app_timer_register(0, prv_startup_timer_callback, NULL);
 }
 
 static void prv_deinit(void) {
     logf();
     window_destroy(s_window);
 
-    hourly_vibes_deinit();
-    connection_vibes_deinit();
-    weather_deinit();
+    if (s_started) {
+        hourly_vibes_deinit();
+        connection_vibes_deinit();
+        weather_deinit();
+    }
+    persist_store_deinit();
+    face_config_deinit();
     enamel_deinit();
 }
 
@@ -0,0 +1,394 @@
+#include <pebble.h>
+#include <pebble-generic-weather/pebble-generic-weather.h>
+#include <pebble-geocode-mapquest/pebble-geocode-mapquest.h>
+#include "persist-store.h"
+#include "face-config.h"
+#include "logging.h"
+
+// keys written by releases before the store existed
+static const uint32_t PERSIST_KEY_LEGACY_WEATHER_INFO = 2;
+static const uint32_t PERSIST_KEY_LEGACY_WEATHER_STATUS = 3;
+static const uint32_t PERSIST_KEY_LEGACY_GEOCODE_COORDINATES = 4;
+
+static const uint32_t PERSIST_KEY_STORE = 5;
+// kept apart from the blob, which has no room left for it
+static const uint32_t PERSIST_KEY_FORECAST = 6;
+// records that change at their own pace, so a flush only rewrites what changed
+static const uint32_t PERSIST_KEY_WIDGETS = 7;
+static const uint32_t PERSIST_KEY_PLACES = 8;
+
+// 4 moved the widgets and places out of the blob into keys of their own
+#define PERSIST_STORE_VERSION 4
+#define PERSIST_STORE_MIN_WRITE_INTERVAL (10 * SECONDS_PER_MINUTE)
+#define PERSIST_STORE_PLACES 4
+#define PERSIST_STORE_FORECAST_MAX 128
+// GenericWeatherConditionUnknown doesn't fit the condition byte
+#define PERSIST_STORE_CONDITION_UNKNOWN 0xff
+
+typedef enum {
+    PersistStoreRecordWeather = 1 << 0,
+    PersistStoreRecordStatus = 1 << 1,
+    PersistStoreRecordCoordinates = 1 << 2,
+    PersistStoreRecordWidgets = 1 << 3,
+    PersistStoreRecordPlaces = 1 << 4,
+    PersistStoreRecordForecast = 1 << 5,
+    // not a record: the blob's header changed, as when a record first appears
+    PersistStoreRecordHeader = 1 << 7
+} PersistStoreRecord;
+
+// what lives in the blob itself under PERSIST_KEY_STORE
+#define PERSIST_STORE_BLOB_RECORDS (PersistStoreRecordWeather | PersistStoreRecordStatus | PersistStoreRecordCoordinates | PersistStoreRecordHeader)
+
+typedef struct __attribute__((__packed__)) {
+    int32_t timestamp;
+    int32_t timesunrise;
+    int32_t timesunset;
+    int8_t temp_c;
+    int8_t temp_f;
+    int8_t temp_feels_like_c;
+    int8_t temp_feels_like_f;
+    int8_t temp_low_c;
+    int8_t temp_low_f;
+    int8_t temp_high_c;
+    int8_t temp_high_f;
+    uint8_t humidity;
+    uint8_t condition;
+    uint8_t day;
+} PersistStoreWeather;
+
+typedef struct __attribute__((__packed__)) {
+    uint32_t name_hash;
+    GeocodeMapquestCoordinates coordinates;
+} PersistStorePlace;
+
+typedef struct __attribute__((__packed__)) {
+    uint8_t version;
+    uint8_t records;
+    uint8_t status;
+    PersistStoreWeather weather;
+    GeocodeMapquestCoordinates coordinates;
+} PersistStoreBlob;
+
+typedef char PersistStoreWidgets[FACE_CONFIG_WIDGET_SLOTS][WIDGET_BUF_LEN];
+// most recently used first, a zero hash marks an empty entry
+typedef PersistStorePlace PersistStorePlaces[PERSIST_STORE_PLACES];
+
+// Versions 1 to 3 kept everything in the blob, each appending to the one before
+typedef struct __attribute__((__packed__)) {
+    PersistStoreBlob blob;
+    PersistStoreWidgets widgets;
+    PersistStorePlaces places;
+} PersistStoreBlobV3;
+
+_Static_assert(sizeof(PersistStoreBlobV3) <= PERSIST_DATA_MAX_LENGTH, "persist store blob too large");
+
+static PersistStoreBlob s_blob;
+static PersistStoreWidgets s_widgets;
+static PersistStorePlaces s_places;
+static uint8_t s_forecast[PERSIST_STORE_FORECAST_MAX];
+static uint8_t s_forecast_length;
+static uint8_t s_dirty;
+static time_t s_last_write;
+static AppTimer *s_timer;
+static bool s_needs_migration;
+
+static bool prv_write_record(uint8_t record, uint32_t key, const void *data, size_t size) {
+    if (!(s_dirty & record)) return true;
+    int written = persist_write_data(key, data, size);
+    if (written < 0) {
+        loge("persist store write of key %ld failed: %d", key, written);
+        return false;
+    }
+    s_dirty &= ~record;
+    return true;
+}
+
+// Writes each dirty record under its own key, leaving the others alone
+static void prv_write(void) {
+    logf();
+    if (!s_dirty) return;
+    s_blob.version = PERSIST_STORE_VERSION;
+    bool ok = prv_write_record(PersistStoreRecordForecast, PERSIST_KEY_FORECAST, s_forecast, s_forecast_length);
+    ok = prv_write_record(PersistStoreRecordWidgets, PERSIST_KEY_WIDGETS, s_widgets, sizeof(s_widgets)) && ok;
+    ok = prv_write_record(PersistStoreRecordPlaces, PERSIST_KEY_PLACES, s_places, sizeof(s_places)) && ok;
+    if (s_dirty & PERSIST_STORE_BLOB_RECORDS) {
+        int written = persist_write_data(PERSIST_KEY_STORE, &s_blob, sizeof(s_blob));
+        if (written < 0) {
+            loge("persist store write failed: %d", written);
+            return;
+        }
+        s_dirty &= ~PERSIST_STORE_BLOB_RECORDS;
+    }
+    if (ok) s_last_write = time(NULL);
+}
+
+// Marks records changed, and the header too when one of them is new
+static void prv_touch(uint8_t records) {
+    if (records & ~s_blob.records) s_dirty |= PersistStoreRecordHeader;
+    s_blob.records |= records;
+    s_dirty |= records;
+}
+
+static void prv_timer_callback(void *context) {
+    logf();
+    s_timer = NULL;
+    prv_write();
+}
+
+static void prv_pack_weather(PersistStoreWeather *weather, const GenericWeatherInfo *info) {
+    memset(weather, 0, sizeof(PersistStoreWeather));
+    weather->timestamp = info->timestamp;
+    weather->timesunrise = info->timesunrise;
+    weather->timesunset = info->timesunset;
+    weather->temp_c = info->temp_c;
+    weather->temp_f = info->temp_f;
+    weather->temp_feels_like_c = info->temp_feels_like_c;
+    weather->temp_feels_like_f = info->temp_feels_like_f;
+    weather->temp_low_c = info->temp_low_c;
+    weather->temp_low_f = info->temp_low_f;
+    weather->temp_high_c = info->temp_high_c;
+    weather->temp_high_f = info->temp_high_f;
+    weather->humidity = info->humidity;
+    weather->condition = info->condition <= GenericWeatherConditionMist ? info->condition : PERSIST_STORE_CONDITION_UNKNOWN;
+    weather->day = info->day;
+}
+
+static void prv_migrate_legacy(void) {
+    logf();
+
+    if (persist_exists(PERSIST_KEY_LEGACY_WEATHER_INFO)) {
+        generic_weather_load(PERSIST_KEY_LEGACY_WEATHER_INFO);
+        prv_pack_weather(&s_blob.weather, generic_weather_peek());
+        prv_touch(PersistStoreRecordWeather);
+        persist_delete(PERSIST_KEY_LEGACY_WEATHER_INFO);
+    }
+
+    if (persist_exists(PERSIST_KEY_LEGACY_WEATHER_STATUS)) {
+        s_blob.status = persist_read_int(PERSIST_KEY_LEGACY_WEATHER_STATUS);
+        prv_touch(PersistStoreRecordStatus);
+        persist_delete(PERSIST_KEY_LEGACY_WEATHER_STATUS);
+    }
+
+#ifndef PBL_PLATFORM_APLITE
+    if (persist_exists(PERSIST_KEY_LEGACY_GEOCODE_COORDINATES)) {
+        geocode_mapquest_load(PERSIST_KEY_LEGACY_GEOCODE_COORDINATES);
+        GeocodeMapquestCoordinates *coordinates = geocode_mapquest_peek();
+        if (coordinates) {
+            s_blob.coordinates = *coordinates;
+            prv_touch(PersistStoreRecordCoordinates);
+        }
+        persist_delete(PERSIST_KEY_LEGACY_GEOCODE_COORDINATES);
+    }
+#endif
+
+    prv_write();
+}
+
+// Moves the widgets and places a version 2 or 3 blob carried into their own keys
+static void prv_split_v3(const PersistStoreBlobV3 *old, int read) {
+    logf();
+    if (read >= (int) offsetof(PersistStoreBlobV3, places) && (old->blob.records & PersistStoreRecordWidgets)) {
+        memcpy(s_widgets, old->widgets, sizeof(s_widgets));
+        s_dirty |= PersistStoreRecordWidgets;
+    } else {
+        s_blob.records &= ~PersistStoreRecordWidgets;
+    }
+    if (read >= (int) sizeof(PersistStoreBlobV3) && (old->blob.records & PersistStoreRecordPlaces)) {
+        memcpy(s_places, old->places, sizeof(s_places));
+        s_dirty |= PersistStoreRecordPlaces;
+    } else {
+        s_blob.records &= ~PersistStoreRecordPlaces;
+    }
+    s_dirty |= PersistStoreRecordHeader;
+    prv_write();
+}
+
+// Only touches the store's own keys so it can run before the weather libraries, see persist_store_migrate
+void persist_store_init(void) {
+    logf();
+    memset(&s_blob, 0, sizeof(s_blob));
+    memset(s_widgets, 0, sizeof(s_widgets));
+    memset(s_places, 0, sizeof(s_places));
+    s_dirty = 0;
+
+    int length = persist_read_data(PERSIST_KEY_FORECAST, s_forecast, sizeof(s_forecast));
+    s_forecast_length = length > 0 ? length : 0;
+
+    s_needs_migration = !persist_exists(PERSIST_KEY_STORE);
+    if (s_needs_migration) return;
+
+    PersistStoreBlobV3 old;
+    memset(&old, 0, sizeof(old));
+    int read = persist_read_data(PERSIST_KEY_STORE, &old, sizeof(old));
+    if (read < (int) offsetof(PersistStoreBlob, weather) || old.blob.version > PERSIST_STORE_VERSION) {
+        logw("discarding persist store version %d", old.blob.version);
+        return;
+    }
+    // a short read from version 1 leaves the coordinates zeroed, as it never had them
+    s_blob = old.blob;
+    if (old.blob.version < 4) {
+        prv_split_v3(&old, read);
+        return;
+    }
+
+    if ((s_blob.records & PersistStoreRecordWidgets) && persist_read_data(PERSIST_KEY_WIDGETS, s_widgets, sizeof(s_widgets)) <= 0) {
+        s_blob.records &= ~PersistStoreRecordWidgets;
+    }
+    if ((s_blob.records & PersistStoreRecordPlaces) && persist_read_data(PERSIST_KEY_PLACES, s_places, sizeof(s_places)) <= 0) {
+        s_blob.records &= ~PersistStoreRecordPlaces;
+    }
+}
+
+// Must run after generic_weather_init and geocode_init so old keys can be migrated
+void persist_store_migrate(void) {
+    logf();
+    if (!s_needs_migration) return;
+    s_needs_migration = false;
+    prv_migrate_legacy();
+}
+
+void persist_store_deinit(void) {
+    logf();
+    if (s_timer) app_timer_cancel(s_timer);
+    s_timer = NULL;
+    prv_write();
+}
+
+void persist_store_flush(void) {
+    logf();
+    if (!s_dirty || s_timer) return;
+
+    time_t elapsed = time(NULL) - s_last_write;
+    if (elapsed >= PERSIST_STORE_MIN_WRITE_INTERVAL) prv_write();
+    else s_timer = app_timer_register((PERSIST_STORE_MIN_WRITE_INTERVAL - elapsed) * 1000, prv_timer_callback, NULL);
+}
+
+void persist_store_set_weather(const GenericWeatherInfo *info, GenericWeatherStatus status) {
+    logf();
+    PersistStoreWeather weather;
+    prv_pack_weather(&weather, info);
+    if (!(s_blob.records & PersistStoreRecordWeather) || memcmp(&weather, &s_blob.weather, sizeof(weather)) != 0) {
+        s_blob.weather = weather;
+        prv_touch(PersistStoreRecordWeather);
+    }
+    persist_store_set_status(status);
+}
+
+// Any outcome is kept, so the next launch shows the last error rather than old weather as fresh
+void persist_store_set_status(GenericWeatherStatus status) {
+    logf();
+    if ((s_blob.records & PersistStoreRecordStatus) && s_blob.status == status) return;
+    s_blob.status = status;
+    prv_touch(PersistStoreRecordStatus);
+}
+
+bool persist_store_get_weather(GenericWeatherInfo *info) {
+    logf();
+    if (!(s_blob.records & PersistStoreRecordWeather)) return false;
+
+    const PersistStoreWeather *weather = &s_blob.weather;
+    info->timestamp = weather->timestamp;
+    info->timesunrise = weather->timesunrise;
+    info->timesunset = weather->timesunset;
+    info->temp_c = weather->temp_c;
+    info->temp_f = weather->temp_f;
+    info->temp_feels_like_c = weather->temp_feels_like_c;
+    info->temp_feels_like_f = weather->temp_feels_like_f;
+    info->temp_low_c = weather->temp_low_c;
+    info->temp_low_f = weather->temp_low_f;
+    info->temp_high_c = weather->temp_high_c;
+    info->temp_high_f = weather->temp_high_f;
+    info->humidity = weather->humidity;
+    // also clamps the truncated Unknown written by earlier builds
+    info->condition = weather->condition <= GenericWeatherConditionMist ? weather->condition : GenericWeatherConditionUnknown;
+    info->day = weather->day;
+    return true;
+}
+
+GenericWeatherStatus persist_store_get_status(void) {
+    logf();
+    return (s_blob.records & PersistStoreRecordStatus) ? s_blob.status : GenericWeatherStatusNotYetFetched;
+}
+
+void persist_store_set_coordinates(const GeocodeMapquestCoordinates *coordinates) {
+    logf();
+    if ((s_blob.records & PersistStoreRecordCoordinates) &&
+            memcmp(&s_blob.coordinates, coordinates, sizeof(GeocodeMapquestCoordinates)) == 0) {
+        return;
+    }
+    s_blob.coordinates = *coordinates;
+    prv_touch(PersistStoreRecordCoordinates);
+}
+
+bool persist_store_get_coordinates(GeocodeMapquestCoordinates *coordinates) {
+    logf();
+    if (!(s_blob.records & PersistStoreRecordCoordinates)) return false;
+    *coordinates = s_blob.coordinates;
+    return true;
+}
+
+void persist_store_set_widget_text(uint8_t slot, const char *text) {
+    logf();
+    if (slot >= FACE_CONFIG_WIDGET_SLOTS) return;
+    if ((s_blob.records & PersistStoreRecordWidgets) && strncmp(s_widgets[slot], text, WIDGET_BUF_LEN) == 0) return;
+    strncpy(s_widgets[slot], text, WIDGET_BUF_LEN);
+    s_widgets[slot][WIDGET_BUF_LEN - 1] = '\0';
+    prv_touch(PersistStoreRecordWidgets);
+}
+
+const char *persist_store_get_widget_text(uint8_t slot) {
+    logf();
+    if (!(s_blob.records & PersistStoreRecordWidgets) || slot >= FACE_CONFIG_WIDGET_SLOTS) return NULL;
+    return s_widgets[slot];
+}
+
+static void prv_use_place(uint8_t index, uint32_t name_hash, const GeocodeMapquestCoordinates *coordinates) {
+    memmove(&s_places[1], &s_places[0], index * sizeof(PersistStorePlace));
+    s_places[0].name_hash = name_hash;
+    s_places[0].coordinates = *coordinates;
+    prv_touch(PersistStoreRecordPlaces);
+}
+
+bool persist_store_get_place(uint32_t name_hash, GeocodeMapquestCoordinates *coordinates) {
+    logf();
+    if (!(s_blob.records & PersistStoreRecordPlaces) || name_hash == 0) return false;
+    for (uint8_t i = 0; i < PERSIST_STORE_PLACES; i++) {
+        if (s_places[i].name_hash != name_hash) continue;
+        *coordinates = s_places[i].coordinates;
+        if (i > 0) prv_use_place(i, name_hash, coordinates);
+        return true;
+    }
+    return false;
+}
+
+void persist_store_set_place(uint32_t name_hash, const GeocodeMapquestCoordinates *coordinates) {
+    logf();
+    if (name_hash == 0) return;
+    uint8_t index = PERSIST_STORE_PLACES - 1;
+    for (uint8_t i = 0; i < PERSIST_STORE_PLACES; i++) {
+        if (s_places[i].name_hash == name_hash) {
+            index = i;
+            break;
+        }
+    }
+    prv_use_place(index, name_hash, coordinates);
+}
+
+void persist_store_set_forecast(const void *data, uint8_t length) {
+    logf();
+    if (length > sizeof(s_forecast)) {
+        loge("forecast too large to persist: %d", length);
+        return;
+    }
+    memcpy(s_forecast, data, length);
+    s_forecast_length = length;
+    s_dirty |= PersistStoreRecordForecast;
+}
+
+// Returns how many bytes were copied, 0 if nothing was stored
+uint8_t persist_store_get_forecast(void *data, uint8_t size) {
+    logf();
+    uint8_t length = s_forecast_length < size ? s_forecast_length : size;
+    memcpy(data, s_forecast, length);
+    return length;
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <pebble.h>
+#include <pebble-generic-weather/pebble-generic-weather.h>
+#include <pebble-geocode-mapquest/pebble-geocode-mapquest.h>
+
+void persist_store_init(void);
+void persist_store_migrate(void);
+void persist_store_deinit(void);
+void persist_store_flush(void);
+
+void persist_store_set_weather(const GenericWeatherInfo *info, GenericWeatherStatus status);
+void persist_store_set_status(GenericWeatherStatus status);
+bool persist_store_get_weather(GenericWeatherInfo *info);
+GenericWeatherStatus persist_store_get_status(void);
+
+void persist_store_set_coordinates(const GeocodeMapquestCoordinates *coordinates);
+bool persist_store_get_coordinates(GeocodeMapquestCoordinates *coordinates);
+
+// least recently used cache of geocoded places, keyed by a hash of the normalized name
+bool persist_store_get_place(uint32_t name_hash, GeocodeMapquestCoordinates *coordinates);
+void persist_store_set_place(uint32_t name_hash, const GeocodeMapquestCoordinates *coordinates);
+
+void persist_store_set_widget_text(uint8_t slot, const char *text);
+const char *persist_store_get_widget_text(uint8_t slot);
+
+void persist_store_set_forecast(const void *data, uint8_t length);
+uint8_t persist_store_get_forecast(void *data, uint8_t size);
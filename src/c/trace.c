@@ -0,0 +1,53 @@
+#include <pebble.h>
+#include "trace.h"
+
+#ifdef TRACE_RING
+
+// Nothing in here may call logf(), it would record itself.
+
+typedef struct __attribute__((__packed__)) {
+    uint32_t site;
+    uint32_t timestamp;
+    int32_t a;
+    int32_t b;
+} TraceRecord;
+
+// Call sites are stored as the offset of their __func__ string from this anchor,
+// which stays the same wherever the app gets loaded. tools/trace-decode.py resolves
+// the anchor in the ELF and reads the names back from there.
+static const char s_trace_anchor[] = "trace";
+
+static TraceRecord s_records[TRACE_RECORDS];
+static uint16_t s_head;
+static uint16_t s_count;
+
+void trace_record(const char *site, int32_t a, int32_t b) {
+    time_t seconds;
+    uint16_t ms;
+    time_ms(&seconds, &ms);
+
+    TraceRecord *record = &s_records[s_head];
+    record->site = (uint32_t) (site - s_trace_anchor);
+    record->timestamp = seconds * 1000 + ms;
+    record->a = a;
+    record->b = b;
+
+    s_head = (s_head + 1) % TRACE_RECORDS;
+    if (s_count < TRACE_RECORDS) s_count++;
+}
+
+// Logs the buffer oldest first and empties it
+void trace_dump(void) {
+    APP_LOG(APP_LOG_LEVEL_INFO, "trace: %u records", s_count);
+    uint16_t index = (s_head + TRACE_RECORDS - s_count) % TRACE_RECORDS;
+    for (uint16_t i = 0; i < s_count; i++) {
+        TraceRecord *record = &s_records[index];
+        APP_LOG(APP_LOG_LEVEL_INFO, "trace %08lx %08lx %08lx %08lx",
+                record->site, record->timestamp, (uint32_t) record->a, (uint32_t) record->b);
+        index = (index + 1) % TRACE_RECORDS;
+    }
+    s_head = 0;
+    s_count = 0;
+}
+
+#endif // TRACE_RING
@@ -0,0 +1,9 @@
+#pragma once
+#include <pebble.h>
+
+#ifndef TRACE_RECORDS
+#define TRACE_RECORDS 64
+#endif
+
+void trace_record(const char *site, int32_t a, int32_t b);
+void trace_dump(void);
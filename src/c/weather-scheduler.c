@@ -0,0 +1,84 @@
+#include <pebble.h>
+#include "weather-scheduler.h"
+#include "logging.h"
+
+#define WEATHER_SCHEDULER_RETRY_BASE 60
+#define WEATHER_SCHEDULER_MAX_DOUBLINGS 6
+#define WEATHER_SCHEDULER_BAD_KEY_COOLDOWN (24 * SECONDS_PER_HOUR)
+
+typedef struct {
+    time_t cooldown_until;
+} WeatherKeyHealth;
+
+static WeatherSchedulerClock s_clock = time;
+static WeatherKeyHealth s_keys[WEATHER_SCHEDULER_MAX_KEYS];
+static uint8_t s_key_count;
+static uint8_t s_key_idx;
+static uint8_t s_failures;
+static uint32_t s_interval = 30 * SECONDS_PER_MINUTE;
+
+static uint32_t prv_backoff(uint8_t failures, uint32_t cap) {
+    uint8_t doublings = failures - 1 < WEATHER_SCHEDULER_MAX_DOUBLINGS ? failures - 1 : WEATHER_SCHEDULER_MAX_DOUBLINGS;
+    uint32_t delay = WEATHER_SCHEDULER_RETRY_BASE << doublings;
+    return delay < cap ? delay : cap;
+}
+
+void weather_scheduler_init(uint8_t key_count, WeatherSchedulerClock clock) {
+    logf();
+    s_clock = clock ? clock : time;
+    s_key_count = key_count < WEATHER_SCHEDULER_MAX_KEYS ? key_count : WEATHER_SCHEDULER_MAX_KEYS;
+    s_key_idx = s_key_count ? rand() / (RAND_MAX / s_key_count + 1) : 0;
+    s_failures = 0;
+    memset(s_keys, 0, sizeof(s_keys));
+}
+
+void weather_scheduler_set_interval(uint32_t interval) {
+    logf();
+    s_interval = interval;
+}
+
+int8_t weather_scheduler_next_key(void) {
+    logf();
+    if (s_key_count == 0) return -1;
+
+    time_t now = s_clock(NULL);
+    int8_t fallback = -1;
+    for (uint8_t n = 0; n < s_key_count; n++) {
+        uint8_t i = (s_key_idx + n) % s_key_count;
+        if (s_keys[i].cooldown_until <= now) {
+            s_key_idx = (i + 1) % s_key_count;
+            return i;
+        }
+        if (fallback < 0 || s_keys[i].cooldown_until < s_keys[fallback].cooldown_until) fallback = i;
+    }
+
+    // every key is cooling down, use the one that recovers first
+    s_key_idx = (fallback + 1) % s_key_count;
+    return fallback;
+}
+
+void weather_scheduler_report(int8_t key, WeatherFetchOutcome outcome) {
+    logf();
+    if (outcome == WeatherFetchSucceeded) {
+        s_failures = 0;
+        if (key >= 0 && key < s_key_count) s_keys[key].cooldown_until = 0;
+        return;
+    }
+
+    if (s_failures < UINT8_MAX) s_failures++;
+    // only a rejected key is rotated away, outages and timeouts just back off
+    if (key < 0 || key >= s_key_count || outcome != WeatherFetchBadKey) return;
+
+    s_keys[key].cooldown_until = s_clock(NULL) + WEATHER_SCHEDULER_BAD_KEY_COOLDOWN;
+}
+
+uint32_t weather_scheduler_next_delay(void) {
+    logf();
+    if (s_failures == 0) return s_interval;
+
+    uint32_t delay = prv_backoff(s_failures, s_interval);
+    // +/- 25% jitter so several watches behind one rate limit don't retry in step
+    int32_t jitter = delay / 4;
+    if (jitter > 0) delay += (rand() % (2 * jitter + 1)) - jitter;
+    return delay < s_interval ? delay : s_interval;
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include <pebble.h>
+
+#define WEATHER_SCHEDULER_MAX_KEYS 10
+
+typedef time_t (*WeatherSchedulerClock)(time_t *tloc);
+
+typedef enum {
+    WeatherFetchSucceeded,
+    WeatherFetchTransientFailure,
+    WeatherFetchBadKey
+} WeatherFetchOutcome;
+
+void weather_scheduler_init(uint8_t key_count, WeatherSchedulerClock clock);
+void weather_scheduler_set_interval(uint32_t interval);
+int8_t weather_scheduler_next_key(void);
+void weather_scheduler_report(int8_t key, WeatherFetchOutcome outcome);
+uint32_t weather_scheduler_next_delay(void);
@@ -2,13 +2,14 @@
 #include <enamel.h>
 #include <pebble-events/pebble-events.h>
 #include <pebble-generic-weather/pebble-generic-weather.h>
-#include <@smallstoneapps/linked-list/linked-list.h>
 #include "logging.h"
+#include "face-config.h"
+#include "weather-scheduler.h"
+#include "persist-store.h"
 #include "geocode.h"
 #include "weather.h"
-
-static const uint32_t PERSIST_KEY_WEATHER_INFO = 2;
-static const uint32_t PERSIST_KEY_WEATHER_STATUS = 3;
+#include "event-bus.h"
+#include "heap-account.h"
 
 #ifndef WEATHER_API_KEY_1
 #error Need at least one weather API key
@@ -70,19 +71,24 @@ static const uint32_t PERSIST_KEY_WEATHER_STATUS = 3;
 #define _WEATHER_API_KEY_10 WEATHER_API_KEY_10
 #endif
 
-typedef struct {
-    EventWeatherHandler handler;
-    void *context;
-} WeatherHandlerState;
+typedef enum {
+    WeatherFetchStateIdle,
+    WeatherFetchStatePending,
+    WeatherFetchStateInFlight,
+    WeatherFetchStateCoolingDown
+} WeatherFetchState;
 
-typedef struct {
-    GenericWeatherInfo *info;
-    GenericWeatherStatus status;
-} WeatherBundle;
+#define WEATHER_FETCH_COALESCE_MS 250
+#define WEATHER_FETCH_TIMEOUT_MS (60 * 1000)
+#define WEATHER_FETCH_COOLDOWN_MS (60 * 1000)
 
 static GenericWeatherStatus s_status = GenericWeatherStatusNotYetFetched;
 
-static LinkedRoot *s_handler_list;
+static WeatherFetchState s_fetch_state = WeatherFetchStateIdle;
+static bool s_fetch_again;
+static AppTimer *s_fetch_timer;
+
+static EventBus s_handler_bus;
 
 static uint16_t s_interval;
 
@@ -109,7 +115,7 @@ static const char* const s_weather_api_keys[] = {
 };
 
 static uint8_t s_weather_api_keys_len;
-static uint8_t s_weather_api_key_idx;
+static int8_t s_weather_api_key_idx = -1;
 
 #ifndef PBL_PLATFORM_APLITE
 static bool s_use_gps;
@@ -123,40 +129,155 @@ static void cancel_timer(void) {
     s_timer = NULL;
 }
 
-static bool each_weather_fetched(void *this, void *context) {
+static void app_timer_callback(void *context);
+static bool request_fetch(bool force);
+
+static WeatherFetchOutcome fetch_outcome(GenericWeatherStatus status) {
     logf();
-    WeatherHandlerState *state = (WeatherHandlerState *) this;
-    WeatherBundle *bundle = (WeatherBundle *) context;
-    state->handler(bundle->info, bundle->status, state->context);
-    return true;
+    switch (status) {
+        case GenericWeatherStatusAvailable: return WeatherFetchSucceeded;
+        case GenericWeatherStatusBadKey: return WeatherFetchBadKey;
+        default: return WeatherFetchTransientFailure;
+    }
 }
 
-static void generic_weather_fetch_callback(GenericWeatherInfo *info, GenericWeatherStatus status) {
+static bool can_fetch(void) {
+    logf();
+    return s_ready && s_connected && event_bus_count(&s_handler_bus) > 0;
+}
+
+static void set_fetch_timer(uint32_t timeout_ms, AppTimerCallback callback) {
+    logf();
+    if (s_fetch_timer) app_timer_cancel(s_fetch_timer);
+    s_fetch_timer = app_timer_register(timeout_ms, callback, NULL);
+}
+
+static void cancel_fetch_timer(void) {
+    logf();
+    if (s_fetch_timer) app_timer_cancel(s_fetch_timer);
+    s_fetch_timer = NULL;
+}
+
+static void fetch_finished(WeatherFetchOutcome outcome) {
+    logf();
+    weather_scheduler_report(s_weather_api_key_idx, outcome);
+
+    // re-arm from the result so failures retry sooner than the full interval
+    cancel_timer();
+    if (can_fetch()) s_timer = app_timer_register(weather_scheduler_next_delay() * 1000, app_timer_callback, NULL);
+}
+
+static void cooldown_timer_callback(void *context) {
+    logf();
+    s_fetch_timer = NULL;
+    s_fetch_state = WeatherFetchStateIdle;
+    if (s_fetch_again) {
+        s_fetch_again = false;
+        request_fetch(true);
+    }
+}
+
+static void in_flight_timer_callback(void *context) {
+    logf();
+    s_fetch_timer = NULL;
+    logw("weather fetch timed out");
+    s_fetch_state = WeatherFetchStateIdle;
+    fetch_finished(WeatherFetchTransientFailure);
+    if (s_fetch_again) {
+        s_fetch_again = false;
+        request_fetch(true);
+    }
+}
+
+static void notify_handlers(GenericWeatherInfo *info, GenericWeatherStatus status) {
+    logf();
+    for (uint i = 0; i < EVENT_BUS_CAPACITY; i++) {
+        EventBusSlot *slot = &s_handler_bus.slots[i];
+        if (slot->handler) ((EventWeatherHandler) slot->handler)(info, status, slot->context);
+    }
+}
+
+static GenericWeatherInfo *shown_weather(const GenericWeatherInfo *observed);
+
+static void weather_update(GenericWeatherInfo *info, GenericWeatherStatus status) {
     logf();
     s_status = status;
+    if (status == GenericWeatherStatusAvailable) persist_store_set_weather(info, status);
+    else persist_store_set_status(status);
+    persist_store_flush();
+    notify_handlers(shown_weather(info), status);
+}
+
+static void generic_weather_fetch_callback(GenericWeatherInfo *info, GenericWeatherStatus status) {
+    logf();
+    // subscribers only hear about the result, not the intermediate pending state
+    if (status == GenericWeatherStatusPending) {
+        s_status = status;
+        return;
+    }
+
+    if (s_fetch_state == WeatherFetchStateInFlight) {
+        s_fetch_state = WeatherFetchStateCoolingDown;
+        set_fetch_timer(WEATHER_FETCH_COOLDOWN_MS, cooldown_timer_callback);
+        fetch_finished(fetch_outcome(status));
+    }
 
-    WeatherBundle bundle = {
-        .info = info,
-        .status = status
-    };
-    linked_list_foreach(s_handler_list, each_weather_fetched, &bundle);
+    weather_update(info, status);
 }
 
 static void do_fetch_weather(void) {
     logf();
 
-    const char *key = s_weather_api_keys[s_weather_api_key_idx++];
-    if (s_weather_api_key_idx > s_weather_api_keys_len - 1) s_weather_api_key_idx = 0;
+    s_weather_api_key_idx = weather_scheduler_next_key();
+    const char *key = s_weather_api_keys[s_weather_api_key_idx < 0 ? 0 : s_weather_api_key_idx];
     logd("weather api key: %s", key);
     generic_weather_set_api_key(key);
 
+    heap_account_begin(HeapSubsystemWeather);
     generic_weather_fetch(generic_weather_fetch_callback);
+    heap_account_end();
 }
 
-static void app_timer_callback(void *context) {
+static void pending_timer_callback(void *context) {
     logf();
+    s_fetch_timer = NULL;
+    if (!can_fetch()) {
+        s_fetch_state = WeatherFetchStateIdle;
+        return;
+    }
+    s_fetch_state = WeatherFetchStateInFlight;
+    set_fetch_timer(WEATHER_FETCH_TIMEOUT_MS, in_flight_timer_callback);
     do_fetch_weather();
-    s_timer = app_timer_register(s_interval * 1000, app_timer_callback, NULL);
+}
+
+// Every trigger funnels through here. Triggers that arrive while a fetch is
+// pending are merged into it; while one is in flight or cooling down they are
+// dropped, unless forced (e.g. the location changed), in which case a single
+// follow-up fetch runs once the cooldown ends. Returns whether a fetch will
+// result from this trigger.
+static bool request_fetch(bool force) {
+    logf();
+    if (!can_fetch()) return false;
+
+    switch (s_fetch_state) {
+        case WeatherFetchStateIdle:
+            s_fetch_state = WeatherFetchStatePending;
+            set_fetch_timer(WEATHER_FETCH_COALESCE_MS, pending_timer_callback);
+            return true;
+        case WeatherFetchStatePending:
+            return true;
+        case WeatherFetchStateInFlight:
+        case WeatherFetchStateCoolingDown:
+            if (force) s_fetch_again = true;
+            return force;
+    }
+    return false;
+}
+
+static void app_timer_callback(void *context) {
+    logf();
+    s_timer = NULL;
+    request_fetch(true);
 }
 
 static void fetch_or_setup_timer(void) {
@@ -165,9 +286,10 @@ static void fetch_or_setup_timer(void) {
     time_t now = time(NULL);
     logd("%ld - %ld", now, info->timestamp);
     if (now - info->timestamp > s_interval) {
-        do_fetch_weather();
-        s_timer = app_timer_register(s_interval * 1000, app_timer_callback, NULL);
+        // a dropped trigger must not take the refresh timer armed by the last fetch with it
+        if (request_fetch(false)) cancel_timer();
     } else {
+        cancel_timer();
         logd("%ld", s_interval - (now - info->timestamp));
         s_timer = app_timer_register((s_interval - (now - info->timestamp)) * 1000, app_timer_callback, NULL);
     }
@@ -191,28 +313,24 @@ static void geocode_handler(GeocodeMapquestCoordinates *coordinates, GeocodeMapq
     } else if (status != GeocodeMapquestStatusPending) {
         generic_weather_set_location(GENERIC_WEATHER_GPS_LOCATION);
     }
-    if (status != GeocodeMapquestStatusPending) {
-        cancel_timer();
-        if (s_ready && s_connected && linked_list_count(s_handler_list) > 0) {
-            do_fetch_weather();
-            s_timer = app_timer_register(s_interval * 1000, app_timer_callback, NULL);
-        }
-    }
+    if (status != GeocodeMapquestStatusPending) request_fetch(true);
 }
 #endif
 
 static void settings_handler(void *context) {
     logf();
-    uint32_t interval = atoi(enamel_get_WEATHER_INTERVAL()) * SECONDS_PER_MINUTE;
-    interval = interval < (30 * SECONDS_PER_MINUTE) ? (30 * SECONDS_PER_MINUTE) : interval;
+    const FaceConfig *config = face_config_get();
+    uint32_t interval = config->weather_interval;
 #ifndef PBL_PLATFORM_APLITE
-    bool use_gps = enamel_get_WEATHER_USE_GPS();
+    bool use_gps = config->weather_use_gps;
     const char *location_name = enamel_get_WEATHER_LOCATION_NAME();
 #endif
     bool fetch_weather = false;
+    bool location_changed = false;
 
     if (interval != s_interval) {
         s_interval = interval;
+        weather_scheduler_set_interval(s_interval);
         fetch_weather = true;
     }
 
@@ -223,6 +341,7 @@ static void settings_handler(void *context) {
         if (use_gps) {
             generic_weather_set_location(GENERIC_WEATHER_GPS_LOCATION);
             fetch_weather = true;
+            location_changed = true;
         } else {
             geocode_fetch(s_location_name);
             fetch_weather = false;
@@ -230,21 +349,188 @@ static void settings_handler(void *context) {
     }
 #endif
 
-    if (fetch_weather) {
-        cancel_timer();
-        if (s_ready && s_connected && linked_list_count(s_handler_list) > 0) {
-            do_fetch_weather();
-            s_timer = app_timer_register(s_interval * 1000, app_timer_callback, NULL);
-        }
+    if (fetch_weather) request_fetch(location_changed);
+}
+
+static int32_t read_uint(const uint8_t *data, uint8_t size) {
+    int32_t value = 0;
+    for (uint8_t i = 0; i < size; i++) value |= (int32_t) data[i] << (8 * i);
+    return value;
+}
+
+// Condition bytes from the phone, 0xff standing for GenericWeatherConditionUnknown.
+// Anything past Mist would index past the icon tables, so it is unknown as well.
+static uint16_t read_condition(uint8_t value) {
+    return value <= GenericWeatherConditionMist ? value : GenericWeatherConditionUnknown;
+}
+
+// WEATHER_COMPACT, packed by packWeather in src/pkjs/index.js, little endian:
+//  0 version, 1 flags (bit 0 day), 2 condition (0xff unknown),
+//  3..10 temp, feels like, low, high as int8 pairs of c and f, 11 humidity,
+// 12 sunrise and 14 sunset as uint16 minutes after local midnight of the timestamp, 16 uint32 timestamp
+#define WEATHER_COMPACT_VERSION 1
+#define WEATHER_COMPACT_LENGTH 20
+
+static bool decode_compact(const uint8_t *data, uint16_t length, GenericWeatherInfo *info) {
+    logf();
+    if (length < WEATHER_COMPACT_LENGTH || data[0] != WEATHER_COMPACT_VERSION) {
+        logw("unsupported compact weather payload");
+        return false;
     }
+
+    time_t timestamp = read_uint(&data[16], 4);
+    struct tm *local = localtime(&timestamp);
+    time_t midnight = timestamp - (local->tm_hour * SECONDS_PER_HOUR + local->tm_min * SECONDS_PER_MINUTE + local->tm_sec);
+
+    info->day = data[1] & 1;
+    info->condition = read_condition(data[2]);
+    info->temp_c = (int8_t) data[3];
+    info->temp_f = (int8_t) data[4];
+    info->temp_feels_like_c = (int8_t) data[5];
+    info->temp_feels_like_f = (int8_t) data[6];
+    info->temp_low_c = (int8_t) data[7];
+    info->temp_low_f = (int8_t) data[8];
+    info->temp_high_c = (int8_t) data[9];
+    info->temp_high_f = (int8_t) data[10];
+    info->humidity = data[11];
+    info->timesunrise = midnight + read_uint(&data[12], 2) * SECONDS_PER_MINUTE;
+    info->timesunset = midnight + read_uint(&data[14], 2) * SECONDS_PER_MINUTE;
+    info->timestamp = timestamp;
+    return true;
+}
+
+// WEATHER_FORECAST, packed by packForecast in src/pkjs/index.js, little endian:
+//  0 version, 1 hour count, 2 uint32 start of the first hour,
+//  6 per hour: temp c and f as int8, condition, flags (bit 0 day)
+#define WEATHER_FORECAST_VERSION 1
+#define WEATHER_FORECAST_HEADER 6
+#define WEATHER_FORECAST_HOURS 24
+
+typedef struct __attribute__((__packed__)) {
+    int8_t temp_c;
+    int8_t temp_f;
+    uint8_t condition;
+    uint8_t flags;
+} WeatherForecastHour;
+
+// Ring of the hours not yet past, head being the hour that begins at start.
+// Persisted as is, so the layout only ever changes with the version.
+typedef struct __attribute__((__packed__)) {
+    uint8_t version;
+    uint8_t head;
+    uint8_t count;
+    int32_t start;
+    WeatherForecastHour hours[WEATHER_FORECAST_HOURS];
+} WeatherForecast;
+
+static WeatherForecast s_forecast;
+static AppTimer *s_forecast_timer;
+// what the face shows, see shown_weather
+static GenericWeatherInfo s_shown;
+
+static void forecast_timer_callback(void *context);
+
+static void cancel_forecast_timer(void) {
+    logf();
+    if (s_forecast_timer) app_timer_cancel(s_forecast_timer);
+    s_forecast_timer = NULL;
+}
+
+// The observed weather with the current forecast hour laid over it, unless it was
+// observed during that hour already. Only ever shown: generic_weather_peek() and the
+// persisted weather keep what was observed, so fetch scheduling and the next launch
+// are unaffected.
+static GenericWeatherInfo *shown_weather(const GenericWeatherInfo *observed) {
+    logg();
+    s_shown = *observed;
+    time_t now = time(NULL);
+    if (s_forecast.count > 0 && now >= s_forecast.start && now < s_forecast.start + SECONDS_PER_HOUR &&
+            observed->timestamp < s_forecast.start) {
+        const WeatherForecastHour *hour = &s_forecast.hours[s_forecast.head];
+        s_shown.temp_c = hour->temp_c;
+        s_shown.temp_f = hour->temp_f;
+        s_shown.condition = read_condition(hour->condition);
+        s_shown.day = hour->flags & 1;
+    }
+    return &s_shown;
+}
+
+// Drops past hours and shows the current one, unless weather was fetched during this hour already
+static void forecast_advance(void) {
+    logf();
+    cancel_forecast_timer();
+    time_t now = time(NULL);
+    while (s_forecast.count > 0 && now >= s_forecast.start + SECONDS_PER_HOUR) {
+        s_forecast.head = (s_forecast.head + 1) % WEATHER_FORECAST_HOURS;
+        s_forecast.count--;
+        s_forecast.start += SECONDS_PER_HOUR;
+    }
+    if (s_forecast.count == 0) return;
+
+    if (now < s_forecast.start) {
+        s_forecast_timer = app_timer_register((s_forecast.start - now) * 1000, forecast_timer_callback, NULL);
+        return;
+    }
+
+    if (generic_weather_peek()->timestamp < s_forecast.start) {
+        notify_handlers(shown_weather(generic_weather_peek()), GenericWeatherStatusAvailable);
+    }
+    s_forecast_timer = app_timer_register((s_forecast.start + SECONDS_PER_HOUR - now) * 1000, forecast_timer_callback, NULL);
+}
+
+static void forecast_timer_callback(void *context) {
+    logf();
+    s_forecast_timer = NULL;
+    forecast_advance();
+}
+
+static void decode_forecast(const uint8_t *data, uint16_t length) {
+    logf();
+    if (length < WEATHER_FORECAST_HEADER || data[0] != WEATHER_FORECAST_VERSION) {
+        logw("unsupported forecast payload");
+        return;
+    }
+
+    uint8_t count = data[1];
+    uint16_t available = (length - WEATHER_FORECAST_HEADER) / sizeof(WeatherForecastHour);
+    if (count > available) count = available;
+    if (count > WEATHER_FORECAST_HOURS) count = WEATHER_FORECAST_HOURS;
+
+    s_forecast.version = WEATHER_FORECAST_VERSION;
+    s_forecast.head = 0;
+    s_forecast.count = count;
+    s_forecast.start = read_uint(&data[2], 4);
+    memcpy(s_forecast.hours, &data[WEATHER_FORECAST_HEADER], count * sizeof(WeatherForecastHour));
+    persist_store_set_forecast(&s_forecast, sizeof(s_forecast));
+    persist_store_flush();
+
+    forecast_advance();
 }
 
 static void inbox_received(DictionaryIterator *iterator, void *context) {
     logf();
-    Tuple *tuple = dict_find(iterator, MESSAGE_KEY_APP_READY);
+    // the phone sends successful fetches in this form instead of the generic weather reply,
+    // and its cached copy along with APP_READY, so this goes first to keep the ready check
+    // below from fetching again. Only weather newer than what is shown replaces it.
+    Tuple *tuple = dict_find(iterator, MESSAGE_KEY_WEATHER_COMPACT);
+    GenericWeatherInfo *info = generic_weather_peek();
+    GenericWeatherInfo decoded = *info;
+    if (tuple && tuple->type == TUPLE_BYTE_ARRAY && decode_compact(tuple->value->data, tuple->length, &decoded)) {
+        bool newer = decoded.timestamp > info->timestamp;
+        if (newer) *info = decoded;
+        // the phone's cached copy leaves any fetch in flight to its own reply, while a
+        // live reply finishes the fetch even when it brings nothing newer
+        if (!dict_find(iterator, MESSAGE_KEY_APP_READY)) generic_weather_fetch_callback(info, GenericWeatherStatusAvailable);
+        else if (newer) weather_update(info, GenericWeatherStatusAvailable);
+    }
+
+    tuple = dict_find(iterator, MESSAGE_KEY_WEATHER_FORECAST);
+    if (tuple && tuple->type == TUPLE_BYTE_ARRAY) decode_forecast(tuple->value->data, tuple->length);
+
+    tuple = dict_find(iterator, MESSAGE_KEY_APP_READY);
     if (tuple && !s_ready) {
         s_ready = true;
-        if (s_connected && linked_list_count(s_handler_list) > 0) fetch_or_setup_timer();
+        if (s_connected && event_bus_count(&s_handler_bus) > 0) fetch_or_setup_timer();
     }
 }
 
@@ -259,29 +545,38 @@ void weather_init(void) {
     for (uint i = 0; i < ARRAY_LENGTH(s_weather_api_keys); i++) {
         if (s_weather_api_keys[i]) s_weather_api_keys_len++;
     }
-    s_weather_api_key_idx = rand() / (RAND_MAX / s_weather_api_keys_len + 1);
+    weather_scheduler_init(s_weather_api_keys_len, time);
 
-    s_status = persist_exists(PERSIST_KEY_WEATHER_STATUS) ? persist_read_int(PERSIST_KEY_WEATHER_STATUS) : GenericWeatherStatusNotYetFetched;
+    event_bus_init(&s_handler_bus);
 
-    s_handler_list = linked_list_create_root();
-
-    s_interval = atoi(enamel_get_WEATHER_INTERVAL()) * SECONDS_PER_MINUTE;
-    s_interval = s_interval < (30 * SECONDS_PER_MINUTE) ? (30 * SECONDS_PER_MINUTE) : s_interval;
+    s_interval = face_config_get()->weather_interval;
+    weather_scheduler_set_interval(s_interval);
 #ifndef PBL_PLATFORM_APLITE
-    s_use_gps = enamel_get_WEATHER_USE_GPS();
+    s_use_gps = face_config_get()->weather_use_gps;
 #endif
 
     generic_weather_init();
 #ifndef PBL_PLATFORM_APLITE
+    heap_account_begin(HeapSubsystemGeocode);
     geocode_init();
+    heap_account_end();
 #endif
 
     generic_weather_set_provider(GenericWeatherProviderWeatherUnderground);
-    generic_weather_load(PERSIST_KEY_WEATHER_INFO);
+
+    persist_store_migrate();
+    persist_store_get_weather(generic_weather_peek());
+    s_status = persist_store_get_status();
+
+    if (persist_store_get_forecast(&s_forecast, sizeof(s_forecast)) != sizeof(s_forecast) ||
+            s_forecast.version != WEATHER_FORECAST_VERSION) {
+        memset(&s_forecast, 0, sizeof(s_forecast));
+    }
+    forecast_advance();
 
 #ifndef PBL_PLATFORM_APLITE
     strncpy(s_location_name, enamel_get_WEATHER_LOCATION_NAME(), sizeof(s_location_name));
-    GeocodeMapquestCoordinates *coordinates = geocode_peek();
+    GeocodeMapquestCoordinates *coordinates = geocode_peek(s_location_name);
     if (s_use_gps || coordinates == NULL || strlen(s_location_name) == 0) {
         generic_weather_set_location(GENERIC_WEATHER_GPS_LOCATION);
     } else {
@@ -310,6 +605,8 @@ void weather_init(void) {
 void weather_deinit(void) {
     logf();
     cancel_timer();
+    cancel_fetch_timer();
+    cancel_forecast_timer();
 
     events_app_message_unsubscribe(s_app_message_event_handle);
     events_connection_service_unsubscribe(s_connection_event_handle);
@@ -317,41 +614,32 @@ void weather_deinit(void) {
 #ifndef PBL_PLATFORM_APLITE
     events_geocode_unsubscribe(s_geocode_event_handle);
 #endif
-    generic_weather_save(PERSIST_KEY_WEATHER_INFO);
     generic_weather_deinit();
 
-    persist_write_int(PERSIST_KEY_WEATHER_STATUS, s_status);
-
 #ifndef PBL_PLATFORM_APLITE
     geocode_deinit();
 #endif
-
-    free(s_handler_list);
 }
 
 EventHandle events_weather_subscribe(EventWeatherHandler handler, void *context) {
     logf();
-    WeatherHandlerState *this = malloc(sizeof(WeatherHandlerState));
-    this->handler = handler;
-    this->context = context;
+    uint8_t count = event_bus_count(&s_handler_bus);
+    EventHandle handle = event_bus_subscribe(&s_handler_bus, (EventBusHandler) handler, context);
 
-    uint16_t count = linked_list_count(s_handler_list);
-    linked_list_append(s_handler_list, this);
-
-    if (count == 0 && s_ready && s_connected) fetch_or_setup_timer();
-    return this;
+    if (handle && count == 0 && s_ready && s_connected) fetch_or_setup_timer();
+    return handle;
 }
 
 void events_weather_unsubscribe(EventHandle handle) {
     logf();
+    if (!event_bus_unsubscribe(&s_handler_bus, handle)) return;
 
-    int16_t index = linked_list_find(s_handler_list, handle);
-    if (index == -1) return;
-
-    free(linked_list_get(s_handler_list, index));
-    linked_list_remove(s_handler_list, index);
+    if (event_bus_count(&s_handler_bus) == 0) cancel_timer();
+}
 
-    if (linked_list_count(s_handler_list) == 0) cancel_timer();
+GenericWeatherInfo *weather_peek(void) {
+    logg();
+    return shown_weather(generic_weather_peek());
 }
 
 GenericWeatherStatus weather_status_peek(void) {
@@ -0,0 +1,126 @@
+#include <pebble.h>
+#include "weather.h"
+#include "widgets.h"
+#include "face-config.h"
+#include "health-aggregator.h"
+#include "logging.h"
+
+static bool prv_fahrenheit(void) {
+    return face_config_get()->weather_unit == WeatherUnitFahrenheit;
+}
+
+static void prv_format_humidity(char *buf, size_t len, const void *data) {
+    const GenericWeatherInfo *info = data;
+    snprintf(buf, len, "HU: %d%%", info->humidity);
+}
+
+static void prv_format_feels_like(char *buf, size_t len, const void *data) {
+    const GenericWeatherInfo *info = data;
+    snprintf(buf, len, "FL: %d°", prv_fahrenheit() ? info->temp_feels_like_f : info->temp_feels_like_c);
+}
+
+static void prv_format_low_temperature(char *buf, size_t len, const void *data) {
+    const GenericWeatherInfo *info = data;
+    snprintf(buf, len, "LO: %d°", prv_fahrenheit() ? info->temp_low_f : info->temp_low_c);
+}
+
+static void prv_format_high_temperature(char *buf, size_t len, const void *data) {
+    const GenericWeatherInfo *info = data;
+    snprintf(buf, len, "HI: %d°", prv_fahrenheit() ? info->temp_high_f : info->temp_high_c);
+}
+
+static void prv_format_sunrise(char *buf, size_t len, const void *data) {
+    const GenericWeatherInfo *info = data;
+    strftime(buf, len, clock_is_24h_style() ? "SR: %H:%M" : "SR: %I:%M", localtime(&info->timesunrise));
+}
+
+static void prv_format_sunset(char *buf, size_t len, const void *data) {
+    const GenericWeatherInfo *info = data;
+    strftime(buf, len, clock_is_24h_style() ? "SS: %H:%M" : "SS: %I:%M", localtime(&info->timesunset));
+}
+
+static void prv_format_battery(char *buf, size_t len, const void *data) {
+    const BatteryChargeState *charge_state = data;
+    snprintf(buf, len, "BT: %d%%", charge_state->charge_percent);
+}
+
+static void prv_format_connection(char *buf, size_t len, const void *data) {
+    const bool *connected = data;
+    snprintf(buf, len, "CN: %s", *connected ? "ON" : "OFF");
+}
+
+static void prv_format_seconds(char *buf, size_t len, const void *data) {
+    strftime(buf, len, "SE: %S", (const struct tm *) data);
+}
+
+#ifdef PBL_HEALTH
+static void prv_format_steps(char *buf, size_t len, const void *data) {
+    HealthValue steps;
+    if (!health_aggregator_peek(HealthAggregatorMetricSteps, &steps)) return;
+    if (steps < 1000) snprintf(buf, len, "ST: %ld", steps);
+    else snprintf(buf, len, "ST: %ld.%ldK", steps / 1000, steps / 100 % 10);
+}
+
+static void prv_format_distance(char *buf, size_t len, const void *data) {
+    HealthValue distance;
+    if (!health_aggregator_peek(HealthAggregatorMetricDistance, &distance)) return;
+    MeasurementSystem system = health_service_get_measurement_system_for_display(HealthMetricWalkedDistanceMeters);
+    if (system == MeasurementSystemMetric) {
+        if (distance < 100) snprintf(buf, len, "DI: %ldm", distance);
+        else if (distance < 1000) snprintf(buf, len, "DI: .%ldkm", distance / 100);
+        else snprintf(buf, len, "DI: %ldkm", distance / 1000);
+    } else {
+        uint tenths = distance * 10 / 1609 % 10;
+        uint whole = distance / 1609;
+        if (whole < 10) snprintf(buf, len, "DI: %d.%dmi", whole, tenths);
+        else snprintf(buf, len, "DI: %dmi", whole);
+    }
+}
+
+static void prv_format_active_seconds(char *buf, size_t len, const void *data) {
+    HealthValue active_seconds;
+    if (!health_aggregator_peek(HealthAggregatorMetricActiveSeconds, &active_seconds)) return;
+    uint minutes = active_seconds / 60;
+    uint hours = minutes / 60;
+    minutes %= 60;
+
+    struct tm t = {
+        .tm_hour = hours,
+        .tm_min = minutes
+    };
+    strftime(buf, len, "AT:%k:%M", &t);
+}
+
+#ifdef PBL_PLATFORM_DIORITE
+static void prv_format_heart_rate(char *buf, size_t len, const void *data) {
+    HealthValue hr;
+    if (!health_aggregator_peek(HealthAggregatorMetricHeartRate, &hr)) return;
+    snprintf(buf, len, "HR: %ld", hr);
+}
+#endif // PBL_PLATFORM_DIORITE
+#endif // PBL_HEALTH
+
+static const WidgetProvider s_widget_providers[WidgetTypeEnd] = {
+    [WidgetTypeHumidity] = { WidgetSourceWeather, 0, prv_format_humidity },
+    [WidgetTypeFeelsLike] = { WidgetSourceWeather, 0, prv_format_feels_like },
+    [WidgetTypeLowTemperature] = { WidgetSourceWeather, 0, prv_format_low_temperature },
+    [WidgetTypeHighTemperature] = { WidgetSourceWeather, 0, prv_format_high_temperature },
+    [WidgetTypeBattery] = { WidgetSourceBattery, 0, prv_format_battery },
+    [WidgetTypeConnection] = { WidgetSourceConnection, 0, prv_format_connection },
+    [WidgetTypeSeconds] = { WidgetSourceTick, SECOND_UNIT, prv_format_seconds },
+    [WidgetTypeSunrise] = { WidgetSourceWeather, 0, prv_format_sunrise },
+    [WidgetTypeSunset] = { WidgetSourceWeather, 0, prv_format_sunset },
+#ifdef PBL_HEALTH
+    [WidgetTypeSteps] = { WidgetSourceHealth, 0, prv_format_steps, HealthAggregatorMetricSteps },
+    [WidgetTypeDistance] = { WidgetSourceHealth, 0, prv_format_distance, HealthAggregatorMetricDistance },
+    [WidgetTypeActiveSeconds] = { WidgetSourceHealth, 0, prv_format_active_seconds, HealthAggregatorMetricActiveSeconds },
+#ifdef PBL_PLATFORM_DIORITE
+    [WidgetTypeHeartRate] = { WidgetSourceHealth, 0, prv_format_heart_rate, HealthAggregatorMetricHeartRate },
+#endif
+#endif
+};
+
+const WidgetProvider *widget_provider_get(WidgetType type) {
+    logg();
+    return &s_widget_providers[type < WidgetTypeEnd ? type : WidgetTypeNone];
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <pebble.h>
+
+#define WIDGET_BUF_LEN 16
+
+typedef enum {
+    WidgetTypeNone = 0,
+    WidgetTypeHumidity,
+    WidgetTypeFeelsLike,
+    WidgetTypeLowTemperature,
+    WidgetTypeHighTemperature,
+    WidgetTypeBattery,
+    WidgetTypeSteps,
+    WidgetTypeConnection,
+    WidgetTypeHeartRate,
+    WidgetTypeDistance,
+    WidgetTypeActiveSeconds,
+    WidgetTypeSeconds,
+    WidgetTypeSunrise,
+    WidgetTypeSunset,
+    WidgetTypeEnd
+} WidgetType;
+
+typedef enum {
+    WidgetSourceNone = 0,
+    WidgetSourceTick = 1 << 0,
+    WidgetSourceWeather = 1 << 1,
+    WidgetSourceBattery = 1 << 2,
+    WidgetSourceHealth = 1 << 3,
+    WidgetSourceConnection = 1 << 4
+} WidgetSource;
+
+// data is a struct tm for tick widgets, GenericWeatherInfo for weather,
+// BatteryChargeState for battery, bool for connection and NULL for health
+typedef void (*WidgetFormatter)(char *buf, size_t len, const void *data);
+
+typedef struct {
+    WidgetSource source;
+    TimeUnits tick_units;
+    WidgetFormatter format;
+    uint8_t health_metrics;
+} WidgetProvider;
+
+const WidgetProvider *widget_provider_get(WidgetType type);
@@ -9,11 +9,326 @@ var genericWeather = new GenericWeather();
 var GeocodeMapquest = require('pebble-geocode-mapquest');
 var geocodeMapquest = new GeocodeMapquest();
 
+// The watch keeps a small cache of geocoded places and only asks on a miss. The same
+// lookups are cached here by normalized name, so a miss on the watch, e.g. after a
+// reinstall, still doesn't reach MapQuest. A cached reply answers the request
+// directly; anything else goes to pebble-geocode-mapquest, whose successful reply is
+// recorded on its way out through Pebble.sendAppMessage.
+var GEOCODE_CACHE_KEY = 'geocodeCache';
+var GEOCODE_CACHE_SIZE = 8;
+var GEOCODE_KEY_PREFIX = 'GEOCODE_MAPQUEST_';
+
+// same rule as normalized_hash in src/c/geocode.c: ASCII lowercase, runs of
+// space, tab and newline collapsed to one space, trimmed
+function normalizeLocation(name) {
+    return name.replace(/[A-Z]/g, function(c) {
+        return c.toLowerCase();
+    }).replace(/[ \t\n]+/g, ' ').replace(/^ | $/g, '');
+}
+
+function loadGeocodeCache() {
+    try {
+        return JSON.parse(localStorage.getItem(GEOCODE_CACHE_KEY)) || [];
+    } catch (e) {
+        return [];
+    }
+}
+
+// entries are [name, reply], most recently used first
+function useGeocodeCache(name, reply) {
+    var cache = loadGeocodeCache().filter(function(entry) {
+        if (entry[0] !== name) return true;
+        if (reply === undefined) reply = entry[1];
+        return false;
+    });
+    if (reply === undefined) return undefined;
+    cache.unshift([name, reply]);
+    localStorage.setItem(GEOCODE_CACHE_KEY, JSON.stringify(cache.slice(0, GEOCODE_CACHE_SIZE)));
+    return reply;
+}
+
+// Lookups pebble-geocode-mapquest is working on, oldest first. Its replies don't say
+// which name they answer, so one is only cached when its lookup was the only one
+// outstanding throughout. Lookups that never got a reply are dropped after a while.
+var GEOCODE_PENDING_TIMEOUT = 60 * 1000;
+var pendingGeocodes = [];
+
+function geocodeRequestName(payload) {
+    var location = payload[GEOCODE_KEY_PREFIX + 'LOCATION'];
+    if (!payload[GEOCODE_KEY_PREFIX + 'REQUEST'] || typeof location !== 'string') return null;
+    var name = normalizeLocation(location);
+    return name.length ? name : null;
+}
+
+function addPendingGeocode(name) {
+    var now = Date.now();
+    pendingGeocodes = pendingGeocodes.filter(function(pending) {
+        return now - pending.time < GEOCODE_PENDING_TIMEOUT;
+    });
+    pendingGeocodes.forEach(function(pending) {
+        pending.alone = false;
+    });
+    pendingGeocodes.push({ name: name, time: now, alone: pendingGeocodes.length === 0 });
+}
+
+function recordGeocodeReply(dict) {
+    if (!dict || !dict[GEOCODE_KEY_PREFIX + 'REPLY']) return;
+    var pending = pendingGeocodes.shift();
+    if (!pending || !pending.alone || pending.name === null) return;
+    if (dict[GEOCODE_KEY_PREFIX + 'LATITUDE'] !== undefined && dict[GEOCODE_KEY_PREFIX + 'LONGITUDE'] !== undefined) {
+        useGeocodeCache(pending.name, dict);
+    }
+}
+
+function geocodeAppMessageHandler(e) {
+    var name = geocodeRequestName(e.payload);
+    var cached = name !== null ? useGeocodeCache(name) : undefined;
+    if (cached !== undefined) {
+        sendAppMessage.call(Pebble, cached);
+        return;
+    }
+    if (e.payload[GEOCODE_KEY_PREFIX + 'REQUEST']) addPendingGeocode(name);
+    geocodeMapquest.appMessageHandler(e);
+}
+
+// Whenever pebble-generic-weather fetches conditions, the hourly forecast for the same
+// place is fetched as well, from the provider and with the API key the watch configured
+// the library with, at most every FORECAST_FETCH_INTERVAL. The place is taken from the
+// library's own provider fetch, in degrees, once it has resolved the watch's location or
+// the phone's position. The next hours are sent as a WEATHER_FORECAST byte array. The
+// watch steps through it on its own every hour, see decode_forecast in src/c/weather.c,
+// so it stays current while the phone is away.
+var WEATHER_FORECAST_VERSION = 1;
+var WEATHER_FORECAST_HOURS = 24;
+var FORECAST_FETCHED_KEY = 'forecastFetched';
+var FORECAST_FETCH_INTERVAL = 3 * 60 * 60;
+
+// the API key of the request the library is serving
+var forecastKey = null;
+
+function firstCondition(table, value) {
+    for (var i = 0; i < table.length; i++) {
+        if (table[i][0].test(value)) return table[i][1];
+    }
+    return WEATHER_CONDITION_UNKNOWN;
+}
+
+function forecastHour(time, tempC, condition, day) {
+    return { time: time, tempC: tempC, tempF: tempC * 9 / 5 + 32, condition: condition, day: day };
+}
+
+// Condition tables are indexed like GenericWeatherCondition: 0 clear sky, 1 scattered
+// clouds, 2 few clouds, 3 broken clouds, 4 shower rain, 5 rain, 6 thunderstorm, 7 snow, 8 mist
+var OWM_CONDITIONS = [
+    [/^01/, 0], [/^02/, 2], [/^03/, 1], [/^04/, 3], [/^09/, 4], [/^10/, 5], [/^11/, 6], [/^13/, 7], [/^50/, 8]
+];
+
+var WU_CONDITIONS = [
+    [/^(clear|sunny)$/, 0],
+    [/^(mostlysunny|partlycloudy)$/, 2],
+    [/^(partlysunny|mostlycloudy)$/, 1],
+    [/^cloudy$/, 3],
+    [/^chancerain$/, 4],
+    [/^rain$/, 5],
+    [/tstorms$/, 6],
+    [/(snow|flurries|sleet)$/, 7],
+    [/^(fog|hazy)$/, 8]
+];
+
+var FORECAST_IO_CONDITIONS = [
+    [/^(clear|wind)/, 0],
+    [/^partly-cloudy/, 2],
+    [/^cloudy$/, 3],
+    [/^rain$/, 5],
+    [/^thunderstorm$/, 6],
+    [/^(snow|sleet|hail)$/, 7],
+    [/^fog$/, 8]
+];
+
+// indexed like GenericWeatherProvider, each with the method pebble-generic-weather
+// fetches that provider's conditions with
+var FORECAST_SOURCES = [{
+    // OpenWeatherMap forecasts in steps of three hours, each standing for the three hours it begins
+    method: '_getWeatherOWM',
+    url: function(key, latitude, longitude) {
+        return 'https://api.openweathermap.org/data/2.5/forecast?lat=' + latitude + '&lon=' + longitude + '&appid=' + key;
+    },
+    hours: function(json) {
+        var hours = [];
+        (json.list || []).forEach(function(step) {
+            var icon = step.weather && step.weather[0] ? step.weather[0].icon : '';
+            for (var i = 0; i < 3; i++) {
+                hours.push(forecastHour(step.dt + i * 60 * 60, step.main.temp - 273.15,
+                    firstCondition(OWM_CONDITIONS, icon), /d$/.test(icon)));
+            }
+        });
+        return hours;
+    }
+}, {
+    method: '_getWeatherWU',
+    url: function(key, latitude, longitude) {
+        return 'https://api.wunderground.com/api/' + key + '/hourly/q/' + latitude + ',' + longitude + '.json';
+    },
+    hours: function(json) {
+        return (json.hourly_forecast || []).map(function(hour) {
+            var result = forecastHour(Number(hour.FCTTIME.epoch), Number(hour.temp.metric),
+                firstCondition(WU_CONDITIONS, hour.icon || ''), !/\/nt_/.test(hour.icon_url || ''));
+            result.tempF = Number(hour.temp.english);
+            return result;
+        });
+    }
+}, {
+    method: '_getWeatherForecastIO',
+    url: function(key, latitude, longitude) {
+        return 'https://api.darksky.net/forecast/' + key + '/' + latitude + ',' + longitude +
+            '?units=si&exclude=currently,minutely,daily,alerts,flags';
+    },
+    hours: function(json) {
+        return ((json.hourly && json.hourly.data) || []).map(function(hour) {
+            var icon = hour.icon || '';
+            return forecastHour(hour.time, hour.temperature, firstCondition(FORECAST_IO_CONDITIONS, icon),
+                !/night$/.test(icon));
+        });
+    }
+}];
+
+function packForecast(hours) {
+    var now = Date.now() / 1000;
+    hours = hours.filter(function(hour) {
+        return hour.time + 60 * 60 > now;
+    }).slice(0, WEATHER_FORECAST_HOURS);
+    if (hours.length === 0) return null;
+
+    var start = hours[0].time;
+    var bytes = [WEATHER_FORECAST_VERSION, hours.length,
+        start & 0xff, (start >>> 8) & 0xff, (start >>> 16) & 0xff, (start >>> 24) & 0xff];
+    hours.forEach(function(hour) {
+        bytes.push(Math.round(hour.tempC) & 0xff, Math.round(hour.tempF) & 0xff, hour.condition, hour.day ? 1 : 0);
+    });
+    return bytes;
+}
+
+function forecastDue() {
+    var fetched = Number(localStorage.getItem(FORECAST_FETCHED_KEY)) || 0;
+    return Date.now() / 1000 - fetched >= FORECAST_FETCH_INTERVAL;
+}
+
+function fetchForecast(source, latitude, longitude) {
+    if (!forecastKey || !forecastDue()) return;
+    var now = Math.floor(Date.now() / 1000);
+    var xhr = new XMLHttpRequest();
+    xhr.onload = function() {
+        if (xhr.status !== 200) return;
+        var forecast;
+        try {
+            forecast = packForecast(source.hours(JSON.parse(xhr.responseText)));
+        } catch (e) {
+            return;
+        }
+        if (!forecast) return;
+        localStorage.setItem(FORECAST_FETCHED_KEY, now);
+        sendAppMessage.call(Pebble, { 'WEATHER_FORECAST': forecast });
+    };
+    xhr.open('GET', source.url(forecastKey, latitude.toFixed(4), longitude.toFixed(4)));
+    xhr.send();
+}
+
+FORECAST_SOURCES.forEach(function(source) {
+    var fetchConditions = genericWeather[source.method];
+    if (typeof fetchConditions !== 'function') return;
+    genericWeather[source.method] = function(coords) {
+        if (coords) fetchForecast(source, Number(coords.latitude), Number(coords.longitude));
+        return fetchConditions.apply(this, arguments);
+    };
+});
+
+// Successful pebble-generic-weather replies are repacked into a single WEATHER_COMPACT
+// byte array holding only what the face shows, see decode_compact in src/c/weather.c.
+// Anything else, including error replies, is sent unchanged.
+var WEATHER_COMPACT_VERSION = 1;
+// condition codes follow GenericWeatherCondition up to mist, anything else is sent as unknown
+var WEATHER_CONDITION_MIST = 8;
+var WEATHER_CONDITION_UNKNOWN = 0xff;
+
+function packCondition(code) {
+    return code >= 0 && code <= WEATHER_CONDITION_MIST ? code : WEATHER_CONDITION_UNKNOWN;
+}
+
+// pairs as pebble-generic-weather converted them, in the order the watch reads them
+var WEATHER_TEMPERATURE_KEYS = [['GW_TEMPC', 'GW_TEMPF'], ['GW_FEELSLIKEC', 'GW_FEELSLIKEF'],
+                                ['GW_TEMPLOWC', 'GW_TEMPLOWF'], ['GW_TEMPHIGHC', 'GW_TEMPHIGHF']];
+
+function minutesAfterMidnight(seconds, midnight) {
+    return Math.max(0, Math.min(0xffff, Math.round((seconds - midnight) / 60)));
+}
+
+function packWeather(dict) {
+    var keys = ['GW_TIMESTAMP', 'GW_HUMIDITY', 'GW_SUNRISE', 'GW_SUNSET', 'GW_DAY', 'GW_CONDITIONCODE'];
+    if (!dict || !dict.GW_REPLY || dict.GW_BADKEY || dict.GW_LOCATIONUNAVAILABLE) return null;
+    WEATHER_TEMPERATURE_KEYS.forEach(function(pair) {
+        keys = keys.concat(pair);
+    });
+    for (var i = 0; i < keys.length; i++) {
+        if (dict[keys[i]] === undefined) return null;
+    }
+
+    // when the provider observed it, as the library reports it, not when it got here
+    var timestamp = dict.GW_TIMESTAMP;
+    var midnight = new Date(timestamp * 1000);
+    midnight.setHours(0, 0, 0, 0);
+    midnight = midnight.getTime() / 1000;
+
+    var bytes = [WEATHER_COMPACT_VERSION, dict.GW_DAY ? 1 : 0, packCondition(dict.GW_CONDITIONCODE)];
+    WEATHER_TEMPERATURE_KEYS.forEach(function(pair) {
+        bytes.push(dict[pair[0]] & 0xff, dict[pair[1]] & 0xff);
+    });
+    bytes.push(dict.GW_HUMIDITY & 0xff);
+    [minutesAfterMidnight(dict.GW_SUNRISE, midnight), minutesAfterMidnight(dict.GW_SUNSET, midnight)].forEach(function(minutes) {
+        bytes.push(minutes & 0xff, (minutes >> 8) & 0xff);
+    });
+    for (var shift = 0; shift < 32; shift += 8) bytes.push((timestamp >>> shift) & 0xff);
+    return bytes;
+}
+
+// The last packed reply is kept so a reloaded face gets weather with APP_READY,
+// without asking the provider again while it is fresh
+var WEATHER_CACHE_KEY = 'weatherCache';
+var WEATHER_CACHE_MAX_AGE = 30 * 60;
+
+function loadWeatherCache() {
+    try {
+        var cache = JSON.parse(localStorage.getItem(WEATHER_CACHE_KEY));
+        if (!cache || !cache.payload || Date.now() / 1000 - cache.timestamp > WEATHER_CACHE_MAX_AGE) return null;
+        return cache.payload;
+    } catch (e) {
+        return null;
+    }
+}
+
+function storeWeatherCache(payload, timestamp) {
+    localStorage.setItem(WEATHER_CACHE_KEY, JSON.stringify({
+        timestamp: timestamp,
+        payload: payload
+    }));
+}
+
+var sendAppMessage = Pebble.sendAppMessage;
+Pebble.sendAppMessage = function(dict, success, failure) {
+    recordGeocodeReply(dict);
+    var compact = packWeather(dict);
+    if (compact) storeWeatherCache(compact, dict.GW_TIMESTAMP);
+    return sendAppMessage.call(Pebble, compact ? { 'WEATHER_COMPACT': compact } : dict, success, failure);
+};
+
 Pebble.addEventListener('appmessage', function(e) {
+    if (e.payload.GW_REQUEST) forecastKey = e.payload.GW_APIKEY;
     genericWeather.appMessageHandler(e);
-    geocodeMapquest.appMessageHandler(e);
+    geocodeAppMessageHandler(e);
 });
 
 Pebble.addEventListener('ready', function() {
-    Pebble.sendAppMessage({ 'APP_READY' : 1 });
+    var message = { 'APP_READY' : 1 };
+    var cached = loadWeatherCache();
+    if (cached) message.WEATHER_COMPACT = cached;
+    sendAppMessage.call(Pebble, message);
 });
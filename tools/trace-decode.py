@@ -0,0 +1,53 @@
+#!/usr/bin/env python
+"""
+Decodes a trace dump from a TRACE_RING build (see src/c/trace.c).
+
+    pebble logs | tools/trace-decode.py build/basalt/pebble-app.elf
+
+Needs pyelftools.
+"""
+import re
+import sys
+from elftools.elf.elffile import ELFFile
+
+RECORD = re.compile(r'trace ([0-9a-f]{8}) ([0-9a-f]{8}) ([0-9a-f]{8}) ([0-9a-f]{8})')
+
+
+def signed(value):
+    return value - (1 << 32) if value & (1 << 31) else value
+
+
+def load_strings(path):
+    elf = ELFFile(open(path, 'rb'))
+    symbols = elf.get_section_by_name('.symtab')
+    anchor = next(symbol['st_value'] for symbol in symbols.iter_symbols() if symbol.name == 's_trace_anchor')
+
+    def read(address):
+        for section in elf.iter_sections():
+            start = section['sh_addr']
+            if section['sh_type'] == 'SHT_PROGBITS' and start <= address < start + section['sh_size']:
+                data = section.data()[address - start:]
+                return data[:data.index(b'\0')].decode()
+        return '?'
+
+    return anchor, read
+
+
+def main():
+    anchor, read = load_strings(sys.argv[1])
+    names = {}
+    start = None
+    for line in sys.stdin:
+        match = RECORD.search(line)
+        if not match:
+            continue
+        site, timestamp, a, b = (int(group, 16) for group in match.groups())
+        if site not in names:
+            names[site] = read((anchor + signed(site)) & 0xffffffff)
+        if start is None:
+            start = timestamp
+        print('{:>8} ms  {:<40} {} {}'.format(timestamp - start, names[site], signed(a), signed(b)))
+
+
+if __name__ == '__main__':
+    main()